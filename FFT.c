@@ -6,53 +6,25 @@
 #include <stdbool.h>
 #include <string.h> // Include for memset
 
+#include "fft_engine.h"
+#include "audio_source.h"
+
 #define N 4096 // Number of points in FFT
 #define SAMPLE_RATE 48000 // Sampling rate in Hz
 #define FILENAME "HCB.wav" // Replace "audio.wav" with your audio file
 
-// Function to perform FFT
-void fft(complex double x[], int n, int step) {
-    if (n <= 1) return;
-
-    // Divide
-    int m = n / 2;
-    complex double even[m], odd[m];
-    for (int i = 0; i < m; i++) {
-        even[i] = x[i * 2];
-        odd[i] = x[i * 2 + 1];
-    }
-
-    // Conquer
-    fft(even, m, step * 2);
-    fft(odd, m, step * 2);
-
-    // Combine
-    for (int i = 0; i < m; i++) {
-        complex double t = cexp(-I * 2 * M_PI * i / n * step) * odd[i];
-        x[i] = even[i] + t;
-        x[i + m] = even[i] - t;
-    }
-}
-
-// Function to read audio file and extract samples
-bool read_audio(const char *filename, double *samples, int *num_samples) {
-    FILE *file = fopen(filename, "rb");
-    if (!file) {
-        printf("Error: Unable to open file.\n");
+// Function to read the first N samples, as doubles in [-1, 1), from an audio source
+bool read_audio(const char *source_spec, double *samples, int *num_samples) {
+    audio_source_t *source = audio_source_open(source_spec, SAMPLE_RATE);
+    if (!source) {
         return false;
     }
 
-    // Skip WAV header
-    fseek(file, 44, SEEK_SET);
-
-    // Read audio samples (16-bit signed integers)
-    int16_t buffer[N];
-    *num_samples = fread(buffer, sizeof(int16_t), N, file);
-    fclose(file);
-
-    // Convert samples to doubles in the range [-1, 1]
-    for (int i = 0; i < *num_samples; i++) {
-        samples[i] = (double)buffer[i] / 32768.0;
+    *num_samples = audio_source_read_block(source, samples, N);
+    audio_source_close(source);
+    if (*num_samples < 0) {
+        printf("Error: Unable to read file.\n");
+        return false;
     }
 
     // Zero out the remaining elements in the samples array
@@ -61,14 +33,15 @@ bool read_audio(const char *filename, double *samples, int *num_samples) {
     return true;
 }
 
-int main() {
+// Usage: FFT [source] (see audio_source.h)
+int main(int argc, char *argv[]) {
     // Example usage
     complex double x[N]; // Input sequence
     double samples[N]; // Array to store audio samples
     int num_samples;
 
     // Read audio file
-    if (!read_audio(FILENAME, samples, &num_samples)) {
+    if (!read_audio(argc > 1 ? argv[1] : FILENAME, samples, &num_samples)) {
         return 1;
     }
 
@@ -78,7 +51,13 @@ int main() {
     }
 
     // Perform FFT
-    fft(x, N, 1);
+    fft_plan_t *plan = fft_plan_create(N, FFT_FORWARD, FFT_PRECISION_DOUBLE);
+    if (!plan) {
+        printf("Error: Unable to create FFT plan.\n");
+        return 1;
+    }
+    fft_plan_execute(plan, x);
+    fft_plan_destroy(plan);
 
     // Print results
     printf("FFT result:\n");
@@ -5,14 +5,33 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include <pthread.h>
+
+#include "fft_engine.h"
+#include "audio_source.h"
+#include "stft.h"
+#include "notes.h"
+#include "peak.h"
+#include "spsc_queue.h"
 
 // Define constants
 #define SAMPLE_RATE 48000
 #define CHUNK_SIZE 4096
+#define NUM_BINS (CHUNK_SIZE / 2 + 1) // Non-redundant bins of a real-input FFT
 #define MIN_SEGMENT_DURATION_SEC 2
 #define MAX_SEGMENT_DURATION_SEC 44
 #define FILENAME "HCB.wav"
 #define FRACTIONAL_BITS 14
+#define HOP_SIZE (CHUNK_SIZE / 4) // 75% frame overlap
+#define STFT_WINDOW STFT_WINDOW_HANN
+#define FFT_PRECISION FFT_PRECISION_FLOAT // Per-frame FFT precision; spectra still accumulate in double
+#define PHASE_VOCODER 1 // Refine peaks from the phase advance between hops; 0: Gaussian interpolation
+#define NUM_TOP_PEAKS 3
+#define PEAK_THRESHOLD 0.05          // Of the normalized spectrum: ignore peaks 26 dB below the strongest
+#define PEAK_MIN_DISTANCE_CENTS 50.0 // At most one peak per note
+#define FFT_WORKERS 2                // Transform stage threads between the reader and the analyzer
+#define PIPELINE_BUFFERS 32          // Frame buffers in flight across all stages
+#define MAX_FRAMES ((MAX_SEGMENT_DURATION_SEC * SAMPLE_RATE + HOP_SIZE - 1) / HOP_SIZE) // the reader stops here: the only duration cap
 
 #ifndef PI
 # define PI	3.14159265358979323846264338327950288
@@ -20,18 +39,20 @@
 
 // Define types
 typedef int32_t fixed_point_t;
-typedef complex double fft_complex_t;
 
 // Function declarations
-bool read_audio(const char *filename, fixed_point_t *samples, int *num_samples);
-void apply_fft(fixed_point_t *samples, fft_complex_t *fft_output, int num_samples);
-void analyze_frequency_spectrum(fft_complex_t *fft_output, int num_samples);
-const char *map_frequency_to_note(double frequency);
+bool read_audio(const char *source_spec, fixed_point_t *samples, int *num_samples);
+void apply_fft(fft_plan_t *plan, const double *samples, fft_complex_t *fft_output, int num_samples,
+               fft_complex_float_t *frame_f);
+void analyze_frequency_spectrum(fft_complex_t *fft_output, int num_samples, const double *peak_bins);
 void apply_bandpass_filter(fft_complex_t magnitude_spectrum[], int lower_bin, int upper_bin);
-void process_audio(const char *filename);
+void process_audio(const char *source_spec);
+
+peak_picker_t *peak_picker;
 
-int main() {
-    process_audio(FILENAME);
+// Usage: FFT48 [source], where source is a WAV file, device or synth:... (see audio_source.h)
+int main(int argc, char *argv[]) {
+    process_audio(argc > 1 ? argv[1] : FILENAME);
     return 0;
 }
 
@@ -96,25 +117,25 @@ void calculate_magnitude_spectrum(fft_complex_t *fft_output, int num_samples, do
     }
 }
 
-// Function to read audio file
-bool read_audio(const char *filename, fixed_point_t *samples, int *num_samples) {
-    FILE *file = fopen(filename, "rb");
-    if (!file) {
-        printf("Error: Unable to open file.\n");
+// Function to read the first CHUNK_SIZE samples of an audio source
+bool read_audio(const char *source_spec, fixed_point_t *samples, int *num_samples) {
+    audio_source_t *source = audio_source_open(source_spec, SAMPLE_RATE);
+    if (!source) {
         return false;
     }
 
-    // Skip WAV header
-    fseek(file, 44, SEEK_SET);
-
-    // Read audio samples (16-bit signed integers) 
-    int16_t buffer[CHUNK_SIZE];
-    *num_samples = fread(buffer, sizeof(int16_t), CHUNK_SIZE, file);
-    fclose(file);
+    // Read audio samples (mono doubles in [-1, 1) from any backend)
+    double buffer[CHUNK_SIZE];
+    *num_samples = audio_source_read_block(source, buffer, CHUNK_SIZE);
+    audio_source_close(source);
+    if (*num_samples < 0) {
+        printf("Error: Unable to read file.\n");
+        return false;
+    }
 
-    // Convert samples to fixed-point representation
+    // Convert samples to fixed-point representation (exact for 16-bit sources)
     for (int i = 0; i < *num_samples; i++) {
-        samples[i] = (fixed_point_t)buffer[i] << FRACTIONAL_BITS;
+        samples[i] = (fixed_point_t)lrint(buffer[i] * (1 << (15 + FRACTIONAL_BITS)));
     }
 
     // Zero out the remaining elements in the samples array
@@ -124,84 +145,33 @@ bool read_audio(const char *filename, fixed_point_t *samples, int *num_samples)
 }
 
 
-// Function to apply FFT to audio samples
-void apply_fft(fixed_point_t *samples, fft_complex_t *fft_output, int num_samples) {
-    if (num_samples <= 1) return;
-
-    // Divide
-    int m = num_samples / 2;
-    fixed_point_t even[m], odd[m]; // Changed from fft_complex_t to fixed_point_t
-    for (int i = 0; i < m; i++) {
-        even[i] = samples[i * 2];
-        odd[i] = samples[i * 2 + 1];
-    }
-
-    // Conquer
-    apply_fft(even, fft_output, m);
-    apply_fft(odd, fft_output + m, m);
-
-    // Combine
-    for (int i = 0; i < m; i++) {
-        fft_complex_t t = cexp(-I * 2 * M_PI * i / num_samples) * odd[i];
-        fft_output[i] = even[i] + t;
-        fft_output[i + m] = even[i] - t;
-    }
-}
-
-
-// Function to map frequency to piano note
-const char *map_frequency_to_note(double frequency) {
-    // Array of piano note frequencies
-    const double note_frequencies[] = {
-        /* Frequency values of piano notes */
-        27.50, 29.14, 30.87, 32.70, 34.65, 36.71, 38.89, 41.20, 43.65, 46.25, 49.00, 51.91, 
-        55.00, 58.27, 61.74, 65.41, 69.30, 73.42, 77.78, 82.41, 87.31, 92.50, 98.00, 103.83, 
-        110.00, 116.54, 123.47, 130.81, 138.59, 146.83, 155.56, 164.81, 174.61, 185.00, 196.00, 
-        207.65, 220.00, 233.08, 246.94, 261.63, 277.18, 293.66, 311.13, 329.63, 349.23, 369.99, 
-        392.00, 415.30, 440.00, 466.16, 493.88, 523.25, 554.37, 587.33, 622.25, 659.26, 698.46, 
-        739.99, 783.99, 830.61, 880.00, 932.33, 987.77, 1046.50, 1108.73, 1174.66, 1244.51, 1318.51, 
-        1396.91, 1479.98, 1567.98, 1661.22, 1760.00, 1864.66, 1975.53, 2093.00, 2217.46, 2349.32, 
-        2489.02, 2637.02, 2793.83, 2959.96, 3135.96, 3322.44, 3520.00, 3729.31, 3951.07, 4186.01
-    };
-
-    // Array of piano note names
-    const char* note_names[] = {
-        /* Names of piano notes */
-        "A0", "A#0/Bb0", "B0", "C1", "C#1/Db1", "D1", "D#1/Eb1", "E1", "F1", "F#1/Gb1", "G1", "G#1/Ab1",
-        "A1", "A#1/Bb1", "B1", "C2", "C#2/Db2", "D2", "D#2/Eb2", "E2", "F2", "F#2/Gb2", "G2", "G#2/Ab2",
-        "A2", "A#2/Bb2", "B2", "C3", "C#3/Db3", "D3", "D#3/Eb3", "E3", "F3", "F#3/Gb3", "G3", "G#3/Ab3",
-        "A3", "A#3/Bb3", "B3", "C4", "C#4/Db4", "D4", "D#4/Eb4", "E4", "F4", "F#4/Gb4", "G4", "G#4/Ab4",
-        "A4", "A#4/Bb4", "B4", "C5", "C#5/Db5", "D5", "D#5/Eb5", "E5", "F5", "F#5/Gb5", "G5", "G#5/Ab5",
-        "A5", "A#5/Bb5", "B5", "C6", "C#6/Db6", "D6", "D#6/Eb6", "E6", "F6", "F#6/Gb6", "G6", "G#6/Ab6",
-        "A6", "A#6/Bb6", "B6", "C7", "C#7/Db7", "D7", "D#7/Eb7", "E7", "F7", "F#7/Gb7", "G7", "G#7/Ab7",
-        "A7", "A#7/Bb7", "B7", "C8"
-    };
-
-    // Find the nearest note frequency
-    double nearest_frequency = note_frequencies[0];
-    double min_difference = fabs(frequency - nearest_frequency);
-    for (int i = 1; i < sizeof(note_frequencies) / sizeof(note_frequencies[0]); i++) {
-        double difference = fabs(frequency - note_frequencies[i]);
-        if (difference < min_difference) {
-            nearest_frequency = note_frequencies[i];
-            min_difference = difference;
+// Function to apply a real-input FFT to audio samples (fft_output holds num_samples / 2 + 1 bins);
+// float plans pack into frame_f, num_samples / 2 + 1 bins the caller allocates once
+void apply_fft(fft_plan_t *plan, const double *samples, fft_complex_t *fft_output, int num_samples,
+               fft_complex_float_t *frame_f) {
+    if (plan->precision == FFT_PRECISION_FLOAT) {
+        // Transform in float, then widen the bins for double-precision accumulation
+        for (int i = 0; i < num_samples / 2; i++) {
+            frame_f[i] = CMPLXF((float)samples[2 * i], (float)samples[2 * i + 1]);
         }
-    }
-
-    // Find the index of the nearest frequency in the note frequencies array
-    int index = 0;
-    for (int i = 0; i < sizeof(note_frequencies) / sizeof(note_frequencies[0]); i++) {
-        if (note_frequencies[i] == nearest_frequency) {
-            index = i;
-            break;
+        fft_plan_execute_real_float_packed(plan, frame_f);
+        for (int i = 0; i <= num_samples / 2; i++) {
+            fft_output[i] = frame_f[i];
         }
+        return;
     }
 
-    // Return the corresponding note name
-    return note_names[index];
+    // Pack sample pairs straight into the output so no widened copy is needed
+    for (int i = 0; i < num_samples / 2; i++) {
+        fft_output[i] = samples[2 * i] + I * samples[2 * i + 1];
+    }
+    fft_plan_execute_real_packed(plan, fft_output);
 }
 
-void analyze_frequency_spectrum(fft_complex_t *fft_output, int num_samples) {
+
+// Function to report the top three peaks; peak_bins optionally gives the refined
+// (fractional) bin of every bin, otherwise peaks are interpolated on log-magnitude
+void analyze_frequency_spectrum(fft_complex_t *fft_output, int num_samples, const double *peak_bins) {
     // Calculate the bin width and maximum frequency
     double bin_width = (double)SAMPLE_RATE / num_samples;
     double max_frequency = 4200;
@@ -215,141 +185,284 @@ void analyze_frequency_spectrum(fft_complex_t *fft_output, int num_samples) {
         magnitudes[i] = magnitude;
     }
 
-    // Find the top three frequencies
-    double top_magnitudes[3] = {0};
-    double top_frequencies[3] = {0};
-    int top_indices[3] = {-1, -1, -1}; // Stores the indices of the top frequencies
-    for (int i = 0; i < num_samples / 2; i++) {
-        if (magnitudes[i] > top_magnitudes[0]) {
-            top_magnitudes[2] = top_magnitudes[1];
-            top_indices[2] = top_indices[1];
-            top_magnitudes[1] = top_magnitudes[0];
-            top_indices[1] = top_indices[0];
-            top_magnitudes[0] = magnitudes[i];
-            top_indices[0] = i;
-        } else if (magnitudes[i] > top_magnitudes[1]) {
-            top_magnitudes[2] = top_magnitudes[1];
-            top_indices[2] = top_indices[1];
-            top_magnitudes[1] = magnitudes[i];
-            top_indices[1] = i;
-        } else if (magnitudes[i] > top_magnitudes[2]) {
-            top_magnitudes[2] = magnitudes[i];
-            top_indices[2] = i;
-        }
+    // Find the strongest peaks, at most one per note
+    peak_t peaks[NUM_TOP_PEAKS];
+    double top_frequencies[NUM_TOP_PEAKS];
+    int num_peaks = peak_picker_find(peak_picker, magnitudes, peaks);
+    for (int i = 0; i < num_peaks; i++) {
+        double bin = peak_bins ? peak_bins[peaks[i].bin]
+                               : peak_interpolate(magnitudes, num_samples / 2, peaks[i].bin, PEAK_INTERP_GAUSSIAN);
+        top_frequencies[i] = bin * bin_width;
     }
-    for(int i = 0; i < 3; i++) {
-    	top_frequencies[i] = top_indices[i] * bin_width;
-        }
-    // Print the top three frequencies
-    for (int i = 0; i < 3; i++) {
+
+    // Print the top frequencies
+    for (int i = 0; i < num_peaks; i++) {
         printf("Top Frequency %d: %.2f Hz\n", i + 1, top_frequencies[i]);
     }
 
     // Map frequencies to notes and print
-    for (int i = 0; i < 3; i++) {
-        double frequency = top_frequencies[i];
-        const char *note = map_frequency_to_note(frequency);
-        printf("Mapped Note %d: %s\n", i + 1, note);
+    note_map_t notes[NUM_TOP_PEAKS];
+    note_map_frequencies(top_frequencies, num_peaks, notes);
+    for (int i = 0; i < num_peaks; i++) {
+        if (notes[i].note < 0) {
+            printf("Mapped Note %d: none\n", i + 1);
+        } else {
+            printf("Mapped Note %d: %s (%+.0f cents)\n", i + 1, note_names[notes[i].note], notes[i].cents);
+        }
     }
 }
 
 
 //Bandpass Filter
 void apply_bandpass_filter(fft_complex_t magnitude_spectrum[], int lower_bin, int upper_bin) {
-    for (int i = 0; i < CHUNK_SIZE; i++) {
+    for (int i = 0; i < NUM_BINS; i++) {
         if (i < lower_bin || i > upper_bin) {
             magnitude_spectrum[i] = 0; // Zero out frequencies outside the bandpass range
         }
     }
 }
 
-// Function to process audio file
-void process_audio(const char *filename) {
-    fixed_point_t samples[CHUNK_SIZE];
-    fft_complex_t fft_output[CHUNK_SIZE];
-    fft_complex_t fft_temp[CHUNK_SIZE];
+// Running state of the analyzer stage
+typedef struct {
+    fft_complex_t fft_output[NUM_BINS]; // magnitudes summed over the current segment
+    fft_complex_t fft_prev[NUM_BINS];   // previous frame, for the phase-vocoder estimate
+    double phase_bins[NUM_BINS];        // magnitude-weighted sum of each bin's instantaneous frequency
+    double phase_weight[NUM_BINS];
+    int have_prev;
+    double segment_duration1;
+} audio_state_t;
+
+// Function to report the notes of one accumulated segment
+static void analyze_segment(audio_state_t *state) {
+    fft_complex_t *fft_output = state->fft_output;
+    double *peak_bins = NULL;
+#if PHASE_VOCODER
+    // Average instantaneous frequency of each bin over the segment, in bins
+    for (int i = 0; i < NUM_BINS; i++) {
+        state->phase_bins[i] = state->phase_weight[i] > 0.0 ? state->phase_bins[i] / state->phase_weight[i] : i;
+    }
+    peak_bins = state->phase_bins;
+#endif
+
+    //Normalize attempt 1:
+    normalize_fft_output(fft_output, NUM_BINS);
+
+    apply_bandpass_filter(fft_output, 1, 360);
 
-    // Open the audio file
-    FILE *file = fopen(filename, "rb");
-    if (!file) {
-        printf("Error: Unable to open file.\n");
+    //Magnitude Spectrum for nonsense
+    //double magnitude_spectrum[CHUNK_SIZE];
+    //calculate_magnitude_spectrum(fft_output, CHUNK_SIZE, magnitude_spectrum);
+
+    //Structure for printing the fft_output array to check filter
+    /*
+    printf("First 5 elements: ");
+    for (int i = 0; i < 5; i++) {
+        printf("%.2f + %.2fi ", creal(fft_output[i]), cimag(fft_output[i]));
+    }
+    printf("\n");
+
+    printf("Last 5 elements: ");
+    for (int i = 4091; i < 4097; i++) {
+        printf("%.2f + %.2fi ", creal(fft_output[i]), cimag(fft_output[i]));
+    }
+    printf("\n");
+    */
+    //Structure to check the magnitude spectrum
+    //print_first_and_last(magnitude_spectrum, CHUNK_SIZE);
+
+    // Analyze frequency content of the segment
+    analyze_frequency_spectrum(fft_output, CHUNK_SIZE, peak_bins);
+
+    //clear FFT array for processing the next segment
+    for (int i = 0; i < NUM_BINS; i++) {
+        fft_output[i] = 0;
+        state->phase_bins[i] = 0;
+        state->phase_weight[i] = 0;
+    }
+}
+
+// Function to add one frame's spectrum to the current segment (analyzer stage)
+static void accumulate_spectrum(audio_state_t *state, const fft_complex_t *spectrum, int frame_size) {
+    // Sum magnitudes: overlapping frames have unrelated phases, so complex sums would cancel
+    for (int i = 0; i < NUM_BINS; i++) {
+        state->fft_output[i] += cabs(spectrum[i]);
+    }
+
+#if PHASE_VOCODER
+    if (state->have_prev) {
+        for (int i = 0; i < NUM_BINS; i++) {
+            double weight = cabs(spectrum[i]);
+            state->phase_bins[i] += weight * peak_phase_bin(state->fft_prev[i], spectrum[i], i, frame_size, HOP_SIZE);
+            state->phase_weight[i] += weight;
+        }
+    }
+    memcpy(state->fft_prev, spectrum, sizeof(state->fft_prev));
+    state->have_prev = 1;
+#endif
+
+    // Update segment duration
+    state->segment_duration1 += (double)HOP_SIZE / SAMPLE_RATE;
+    if (state->segment_duration1 >= MIN_SEGMENT_DURATION_SEC) {
+        state->segment_duration1 = 0;
+        analyze_segment(state);
+    }
+}
+
+// One STFT frame travelling reader -> FFT worker -> analyzer -> back to the reader
+typedef struct {
+    double samples[CHUNK_SIZE];       // windowed frame
+    fft_complex_t spectrum[NUM_BINS];
+    int last;                         // end-of-stream marker: carries no frame
+} frame_buffer_t;
+
+// Stage connections. Frame f goes to worker f % FFT_WORKERS and the analyzer
+// collects in the same order, so every queue stays single-producer /
+// single-consumer and frames reach the analyzer in time order.
+typedef struct {
+    audio_source_t *source;
+    stft_t *stft;
+    spsc_queue_t *free_buffers;              // analyzer -> reader
+    spsc_queue_t *to_fft[FFT_WORKERS];       // reader -> worker
+    spsc_queue_t *to_analyzer[FFT_WORKERS];  // worker -> analyzer
+    long frames_sent;
+} pipeline_t;
+
+typedef struct {
+    pipeline_t *pipeline;
+    int index;
+    fft_plan_t *plan; // per worker: SIMD plans carry scratch
+    fft_complex_float_t *frame_f; // per worker: packed frame for float plans
+} fft_worker_t;
+
+// Function called by the STFT for every windowed frame (reader stage)
+static void emit_frame(const double *frame, int frame_size, void *user) {
+    pipeline_t *pipeline = user;
+    if (pipeline->frames_sent >= MAX_FRAMES) {
         return;
     }
 
-    // Skip WAV header
-    fseek(file, 44, SEEK_SET);
+    // Waiting for a free buffer is the backpressure from the later stages
+    frame_buffer_t *buffer = spsc_pop_wait(pipeline->free_buffers);
+    memcpy(buffer->samples, frame, frame_size * sizeof(double));
+    buffer->last = 0;
+    spsc_push_wait(pipeline->to_fft[pipeline->frames_sent % FFT_WORKERS], buffer);
+    pipeline->frames_sent++;
+}
 
-    // Process audio in chunks until the desired segment duration is reached
-    double segment_duration1 = 0;
-    double segment_duration = 0; 
-    while (segment_duration < MAX_SEGMENT_DURATION_SEC) {
-        // Read a chunk of audio samples
-        size_t num_samples_read = fread(samples, sizeof(fixed_point_t), CHUNK_SIZE, file);
+// Reader stage: sample acquisition and framing, then one end marker per worker
+static void *reader_main(void *arg) {
+    pipeline_t *pipeline = arg;
+    double block[CHUNK_SIZE];
 
-        // Check if the chunk contains enough samples
-        if (num_samples_read < CHUNK_SIZE) {
-            // Handle incomplete chunk (optional)
+    while (pipeline->frames_sent < MAX_FRAMES) {
+        int num_samples_read = audio_source_read_block(pipeline->source, block, CHUNK_SIZE);
+        if (num_samples_read <= 0) {
             break;
         }
+        stft_push(pipeline->stft, block, num_samples_read, emit_frame, pipeline);
+    }
 
-        // Apply bandpass filter
-        //apply_bandpass_filter(samples, 27, 4200);
-        
-        while(segment_duration1 < MIN_SEGMENT_DURATION_SEC){
-        
-        	// Apply FFT to the chunk
-        	apply_fft(samples, fft_temp, CHUNK_SIZE);
-        
-        	for (int i = 0; i < CHUNK_SIZE; i++) {
-    			fft_output[i] += fft_temp[i];
-			}
-        	// Update segment duration
-        	segment_duration1 += (double)CHUNK_SIZE / SAMPLE_RATE;
-        	segment_duration += (double)CHUNK_SIZE / SAMPLE_RATE;
-        	//printf("%f", segment_duration);
+    for (int w = 0; w < FFT_WORKERS; w++) {
+        frame_buffer_t *marker = spsc_pop_wait(pipeline->free_buffers);
+        marker->last = 1;
+        spsc_push_wait(pipeline->to_fft[(pipeline->frames_sent + w) % FFT_WORKERS], marker);
+    }
+    return NULL;
+}
+
+// FFT stage: transform frames until the end marker, passing everything on
+static void *fft_worker_main(void *arg) {
+    fft_worker_t *worker = arg;
+    pipeline_t *pipeline = worker->pipeline;
+
+    for (;;) {
+        frame_buffer_t *buffer = spsc_pop_wait(pipeline->to_fft[worker->index]);
+        int last = buffer->last; // the buffer belongs to the analyzer once pushed
+        if (!last) {
+            apply_fft(worker->plan, buffer->samples, buffer->spectrum, CHUNK_SIZE, worker->frame_f);
         }
-        segment_duration1 = 0;
-        //printf("%f\n", segment_duration);
-        
-        //Normalize attempt 1:
-        normalize_fft_output(fft_output, CHUNK_SIZE);
-        
-        apply_bandpass_filter(fft_output, 1, 360);
-        
-        
-        //Magnitude Spectrum for nonsense
-        //double magnitude_spectrum[CHUNK_SIZE];
-        //calculate_magnitude_spectrum(fft_output, CHUNK_SIZE, magnitude_spectrum);
-    	
-    	//Structure for printing the fft_output array to check filter
-    	/*
-        printf("First 5 elements: ");
-    	for (int i = 0; i < 5; i++) {
-        	printf("%.2f + %.2fi ", creal(fft_output[i]), cimag(fft_output[i]));
-    		}
-    	printf("\n");
-
-    	printf("Last 5 elements: ");
-    	for (int i = 4091; i < 4097; i++) {
-        	printf("%.2f + %.2fi ", creal(fft_output[i]), cimag(fft_output[i]));
-    	}
-   	 	printf("\n"); 
-		*/
-		//Structure to check the magnitude spectrum
-    	//print_first_and_last(magnitude_spectrum, CHUNK_SIZE);
-    	
-        // Analyze frequency content of the chunk
-        analyze_frequency_spectrum(fft_output, CHUNK_SIZE);
-        
-        //clear FFT array for processing the next chunk
-        for (int i = 0; i < CHUNK_SIZE; i++) {
-    			fft_output[i] = 0;
-			}
-
-        // Update segment duration
-        //segment_duration += (double)CHUNK_SIZE / SAMPLE_RATE;
-    }
-
-    // Close the audio file
-    fclose(file);
+        spsc_push_wait(pipeline->to_analyzer[worker->index], buffer);
+        if (last) {
+            return NULL;
+        }
+    }
+}
+
+// Function to process audio: reader thread -> FFT_WORKERS threads -> analyzer (this thread)
+void process_audio(const char *source_spec) {
+    static frame_buffer_t buffers[PIPELINE_BUFFERS];
+    static audio_state_t state;
+    pipeline_t pipeline = {0};
+    fft_worker_t workers[FFT_WORKERS] = {0};
+    pthread_t reader_thread, worker_threads[FFT_WORKERS];
+    bool ok = true;
+
+    // Open the audio source: a WAV file, the device or a generator
+    pipeline.source = audio_source_open(source_spec, SAMPLE_RATE);
+    if (!pipeline.source) {
+        return;
+    }
+
+    // Build the FFT tables, the analysis window and the queues once for this source
+    pipeline.stft = stft_create(CHUNK_SIZE, HOP_SIZE, STFT_WINDOW);
+    pipeline.free_buffers = spsc_create(PIPELINE_BUFFERS);
+    peak_picker = peak_picker_create(CHUNK_SIZE / 2, NUM_TOP_PEAKS);
+    ok = pipeline.stft && pipeline.free_buffers && peak_picker;
+    for (int w = 0; w < FFT_WORKERS; w++) {
+        pipeline.to_fft[w] = spsc_create(PIPELINE_BUFFERS);
+        pipeline.to_analyzer[w] = spsc_create(PIPELINE_BUFFERS);
+        workers[w].pipeline = &pipeline;
+        workers[w].index = w;
+        workers[w].plan = fft_plan_create_real(CHUNK_SIZE, FFT_PRECISION);
+        workers[w].frame_f = malloc((CHUNK_SIZE / 2 + 1) * sizeof(fft_complex_float_t));
+        ok = ok && pipeline.to_fft[w] && pipeline.to_analyzer[w] && workers[w].plan && workers[w].frame_f;
+    }
+
+    if (!ok) {
+        printf("Error: Unable to create FFT plan.\n");
+    } else {
+        peak_picker->threshold = PEAK_THRESHOLD;
+        peak_picker->min_distance_cents = PEAK_MIN_DISTANCE_CENTS;
+        for (int b = 0; b < PIPELINE_BUFFERS; b++) {
+            spsc_push(pipeline.free_buffers, &buffers[b]);
+        }
+
+        for (int w = 0; w < FFT_WORKERS; w++) {
+            if (pthread_create(&worker_threads[w], NULL, fft_worker_main, &workers[w]) != 0) {
+                printf("Error: Unable to start FFT worker.\n");
+                exit(1);
+            }
+        }
+        if (pthread_create(&reader_thread, NULL, reader_main, &pipeline) != 0) {
+            printf("Error: Unable to start reader.\n");
+            exit(1);
+        }
+
+        // Analyzer stage: collect round-robin, in frame order, until the end marker
+        for (long f = 0;; f++) {
+            frame_buffer_t *buffer = spsc_pop_wait(pipeline.to_analyzer[f % FFT_WORKERS]);
+            if (buffer->last) {
+                break;
+            }
+            accumulate_spectrum(&state, buffer->spectrum, CHUNK_SIZE);
+            spsc_push_wait(pipeline.free_buffers, buffer);
+        }
+
+        pthread_join(reader_thread, NULL);
+        for (int w = 0; w < FFT_WORKERS; w++) {
+            pthread_join(worker_threads[w], NULL);
+        }
+    }
+
+    // Close the audio source
+    for (int w = 0; w < FFT_WORKERS; w++) {
+        spsc_destroy(pipeline.to_fft[w]);
+        spsc_destroy(pipeline.to_analyzer[w]);
+        fft_plan_destroy(workers[w].plan);
+        free(workers[w].frame_f);
+    }
+    spsc_destroy(pipeline.free_buffers);
+    stft_destroy(pipeline.stft);
+    peak_picker_destroy(peak_picker);
+    audio_source_close(pipeline.source);
 }
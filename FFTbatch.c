@@ -0,0 +1,285 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <complex.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#include "fft_engine.h"
+#include "wav_reader.h"
+#include "stft.h"
+#include "notes.h"
+#include "peak.h"
+
+// Offline whole-file analysis: the mapped recording is cut into report
+// windows, the windows are analyzed on a thread pool, and the reports are
+// printed in time order once every window is done.
+
+// Define constants
+#define SAMPLE_RATE 48000
+#define CHUNK_SIZE 4096
+#define NUM_BINS (CHUNK_SIZE / 2 + 1) // Non-redundant bins of a real-input FFT
+#define HOP_SIZE (CHUNK_SIZE / 4)     // 75% frame overlap
+#define STFT_WINDOW STFT_WINDOW_HANN
+#define REPORT_SECONDS 2
+#define REPORT_FRAMES ((REPORT_SECONDS * SAMPLE_RATE + HOP_SIZE - 1) / HOP_SIZE) // hops per report, as in FFT48
+#define LOWER_BIN 1   // Same band as FFT48's bandpass filter
+#define UPPER_BIN 360
+#define NUM_TOP_PEAKS 3
+#define PEAK_THRESHOLD 0.05          // Of the normalized spectrum: ignore peaks 26 dB below the strongest
+#define PEAK_MIN_DISTANCE_CENTS 50.0 // At most one peak per note
+#define FILENAME "HCB.wav"
+
+// Notes found in one report window
+typedef struct {
+    double start_time;
+    int num_peaks;
+    double frequencies[NUM_TOP_PEAKS];
+    note_map_t notes[NUM_TOP_PEAKS];
+} segment_report_t;
+
+// Work shared by every thread; jobs are handed out by an atomic counter
+typedef struct {
+    const wav_map_t *wav;
+    long num_frames;    // STFT frames in the whole file
+    int num_segments;
+    atomic_int next_segment;
+    segment_report_t *reports;
+} batch_t;
+
+// Per-thread analysis state: each worker owns its plan, framer and accumulators
+typedef struct {
+    batch_t *batch;
+    fft_plan_t *plan;
+    stft_t *stft;
+    peak_picker_t *picker;
+    fft_complex_t spectrum[NUM_BINS];
+    fft_complex_t previous[NUM_BINS];
+    double magnitudes[NUM_BINS];    // summed over the window
+    double phase_bins[NUM_BINS];    // magnitude-weighted instantaneous frequency, in bins
+    double phase_weight[NUM_BINS];
+    int frames;
+} worker_t;
+
+// Function called by the STFT for every windowed frame of a segment
+static void accumulate_frame(const double *frame, int frame_size, void *user) {
+    worker_t *worker = user;
+
+    for (int i = 0; i < frame_size / 2; i++) {
+        worker->spectrum[i] = frame[2 * i] + I * frame[2 * i + 1];
+    }
+    fft_plan_execute_real_packed(worker->plan, worker->spectrum);
+
+    for (int i = LOWER_BIN; i <= UPPER_BIN; i++) {
+        double magnitude = cabs(worker->spectrum[i]);
+        worker->magnitudes[i] += magnitude;
+        if (worker->frames > 0) {
+            worker->phase_bins[i] += magnitude * peak_phase_bin(worker->previous[i], worker->spectrum[i], i, frame_size, HOP_SIZE);
+            worker->phase_weight[i] += magnitude;
+        }
+    }
+    memcpy(worker->previous, worker->spectrum, sizeof(worker->previous));
+    worker->frames++;
+}
+
+// Function to analyze report window s: frames s * REPORT_FRAMES onwards
+static void analyze_segment(worker_t *worker, int s) {
+    batch_t *batch = worker->batch;
+    long first_frame = (long)s * REPORT_FRAMES;
+    long num_frames = batch->num_frames - first_frame;
+    if (num_frames > REPORT_FRAMES) {
+        num_frames = REPORT_FRAMES;
+    }
+
+    memset(worker->magnitudes, 0, sizeof(worker->magnitudes));
+    memset(worker->phase_bins, 0, sizeof(worker->phase_bins));
+    memset(worker->phase_weight, 0, sizeof(worker->phase_weight));
+    worker->frames = 0;
+
+    // The window's frames overlap the next window's samples by CHUNK_SIZE - HOP_SIZE;
+    // pushing exactly the samples they cover makes the framer emit exactly those frames.
+    // Frames interleave the channels; mix them down to mono as wav_read_frames() does.
+    int channels = batch->wav->format.channels;
+    const int16_t *pcm = batch->wav->samples + first_frame * HOP_SIZE * channels;
+    long remaining = (num_frames - 1) * HOP_SIZE + CHUNK_SIZE;
+    double block[CHUNK_SIZE];
+    stft_reset(worker->stft);
+    while (remaining > 0) {
+        int count = remaining < CHUNK_SIZE ? (int)remaining : CHUNK_SIZE;
+        for (int i = 0; i < count; i++) {
+            int sum = 0;
+            for (int c = 0; c < channels; c++) {
+                sum += pcm[i * channels + c];
+            }
+            block[i] = (sum / channels) / 32768.0;
+        }
+        stft_push(worker->stft, block, count, accumulate_frame, worker);
+        pcm += count * channels;
+        remaining -= count;
+    }
+
+    // Normalize to the strongest bin, then report the top peaks at their phase-refined frequency
+    double max_magnitude = 0.0;
+    for (int i = 0; i < NUM_BINS; i++) {
+        if (worker->magnitudes[i] > max_magnitude) {
+            max_magnitude = worker->magnitudes[i];
+        }
+    }
+    if (max_magnitude > 0.0) {
+        for (int i = 0; i < NUM_BINS; i++) {
+            worker->magnitudes[i] /= max_magnitude;
+        }
+    }
+
+    segment_report_t *report = &batch->reports[s];
+    peak_t peaks[NUM_TOP_PEAKS];
+    report->start_time = (double)first_frame * HOP_SIZE / SAMPLE_RATE;
+    report->num_peaks = peak_picker_find(worker->picker, worker->magnitudes, peaks);
+    for (int i = 0; i < report->num_peaks; i++) {
+        int k = peaks[i].bin;
+        double bin = worker->phase_weight[k] > 0.0 ? worker->phase_bins[k] / worker->phase_weight[k] : k;
+        report->frequencies[i] = bin * SAMPLE_RATE / CHUNK_SIZE;
+    }
+    note_map_frequencies(report->frequencies, report->num_peaks, report->notes);
+}
+
+// Thread body: take segments until none are left
+static void *worker_main(void *arg) {
+    worker_t *worker = arg;
+    batch_t *batch = worker->batch;
+
+    for (;;) {
+        int s = atomic_fetch_add(&batch->next_segment, 1);
+        if (s >= batch->num_segments) {
+            break;
+        }
+        analyze_segment(worker, s);
+    }
+    return NULL;
+}
+
+static int worker_init(worker_t *worker, batch_t *batch) {
+    worker->batch = batch;
+    worker->plan = fft_plan_create_real(CHUNK_SIZE, FFT_PRECISION_DOUBLE);
+    worker->stft = stft_create(CHUNK_SIZE, HOP_SIZE, STFT_WINDOW);
+    worker->picker = peak_picker_create(NUM_BINS, NUM_TOP_PEAKS);
+    if (!worker->plan || !worker->stft || !worker->picker) {
+        return 0;
+    }
+    worker->picker->threshold = PEAK_THRESHOLD;
+    worker->picker->min_distance_cents = PEAK_MIN_DISTANCE_CENTS;
+    return 1;
+}
+
+static void worker_free(worker_t *worker) {
+    fft_plan_destroy(worker->plan);
+    stft_destroy(worker->stft);
+    peak_picker_destroy(worker->picker);
+}
+
+// Usage: FFTbatch [file.wav] [threads]
+int main(int argc, char *argv[]) {
+    const char *filename = argc > 1 ? argv[1] : FILENAME;
+    int num_threads = argc > 2 ? atoi(argv[2]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+
+    wav_map_t *wav = wav_map_open(filename);
+    if (!wav) {
+        printf("Error: Unable to open file.\n");
+        return 1;
+    }
+    if (wav->format.sample_rate != SAMPLE_RATE) {
+        printf("Error: Sample rate is %d Hz; the analysis expects %d Hz.\n", wav->format.sample_rate, SAMPLE_RATE);
+        wav_map_close(wav);
+        return 1;
+    }
+    if (wav->num_frames < CHUNK_SIZE) {
+        printf("Error: File is shorter than one frame.\n");
+        wav_map_close(wav);
+        return 1;
+    }
+
+    // Counted in frames (one sample per channel); the last window may be short, it is still reported
+    batch_t batch = {0};
+    batch.wav = wav;
+    batch.num_frames = (long)(wav->num_frames - CHUNK_SIZE) / HOP_SIZE + 1;
+    batch.num_segments = (int)((batch.num_frames + REPORT_FRAMES - 1) / REPORT_FRAMES);
+    batch.reports = calloc(batch.num_segments, sizeof(segment_report_t));
+    if (num_threads > batch.num_segments) {
+        num_threads = batch.num_segments;
+    }
+    worker_t *workers = calloc(num_threads, sizeof(worker_t));
+    pthread_t *threads = calloc(num_threads, sizeof(pthread_t));
+    if (!batch.reports || !workers || !threads) {
+        printf("Error: Out of memory.\n");
+        free(batch.reports);
+        free(workers);
+        free(threads);
+        wav_map_close(wav);
+        return 1;
+    }
+
+    for (int t = 0; t < num_threads; t++) {
+        if (!worker_init(&workers[t], &batch)) {
+            printf("Error: Unable to create FFT plan.\n");
+            for (int u = 0; u <= t; u++) {
+                worker_free(&workers[u]);
+            }
+            free(batch.reports);
+            free(workers);
+            free(threads);
+            wav_map_close(wav);
+            return 1;
+        }
+    }
+
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    // The main thread is worker 0; if a thread cannot start, the others take its share
+    int started = 1;
+    for (; started < num_threads; started++) {
+        if (pthread_create(&threads[started], NULL, worker_main, &workers[started]) != 0) {
+            break;
+        }
+    }
+    worker_main(&workers[0]);
+    for (int t = 1; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    for (int t = 0; t < num_threads; t++) {
+        worker_free(&workers[t]);
+    }
+
+    // Reports are indexed by segment, so printing in index order is time order
+    for (int s = 0; s < batch.num_segments; s++) {
+        const segment_report_t *report = &batch.reports[s];
+        printf("[%8.2f s]", report->start_time);
+        for (int i = 0; i < report->num_peaks; i++) {
+            if (report->notes[i].note < 0) {
+                printf(" %.2f Hz (none)", report->frequencies[i]);
+            } else {
+                printf(" %s (%.2f Hz, %+.0f cents)", note_names[report->notes[i].note], report->frequencies[i],
+                       report->notes[i].cents);
+            }
+        }
+        printf("\n");
+    }
+    fprintf(stderr, "Analyzed %.1f s of audio in %.3f s on %d threads\n",
+            (double)wav->num_frames / SAMPLE_RATE,
+            (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) * 1e-9, started);
+
+    free(batch.reports);
+    free(workers);
+    free(threads);
+    wav_map_close(wav);
+    return 0;
+}
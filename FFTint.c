@@ -6,6 +6,9 @@
 #include <stdbool.h>
 #include <string.h> // Include for memset
 
+#include "fft_engine.h"
+#include "audio_source.h"
+
 #define N 4096 // Number of points in FFT
 #define SAMPLE_RATE 48000 // Sampling rate in Hz
 #define FILENAME "HCB.wav" // Replace "audio.wav" with your audio file
@@ -25,38 +28,9 @@ double fixed_to_double(fixed_point_t value) {
     return (double)value / (1 << FRACTIONAL_BITS);
 }
 
-// Function to perform FFT
-void fft(complex double x[], int n, int step) {
-    if (n <= 1) return;
-
-    // Divide
-    int m = n / 2;
-    complex double even[m], odd[m];
-    for (int i = 0; i < m; i++) {
-        even[i] = x[i * 2];
-        odd[i] = x[i * 2 + 1];
-    }
-
-    // Conquer
-    fft(even, m, step * 2);
-    fft(odd, m, step * 2);
-
-    // Combine
-    for (int i = 0; i < m; i++) {
-        complex double t = cexp(-I * 2 * M_PI * i / n * step) * odd[i];
-        x[i] = even[i] + t;
-        x[i + m] = even[i] - t;
-    }
-}
-
-void ifft(complex double x[], int n, int step) {
-    // Conjugate the input data
-    for (int i = 0; i < n; i++) {
-        x[i] = conj(x[i]);
-    }
-
-    // Apply forward FFT
-    fft(x, n, step);
+void ifft(fft_plan_t *inverse_plan, complex double x[], int n) {
+    // Apply inverse FFT
+    fft_plan_execute(inverse_plan, x);
 
     // Normalize by the number of points
     for (int i = 0; i < n; i++) {
@@ -66,25 +40,25 @@ void ifft(complex double x[], int n, int step) {
 
 
 
-// Function to read audio file and extract samples
-bool read_audio(const char *filename, fixed_point_t *samples, int *num_samples) {
-    FILE *file = fopen(filename, "rb");
-    if (!file) {
-        printf("Error: Unable to open file.\n");
+// Function to read the first N samples of an audio source
+bool read_audio(const char *source_spec, fixed_point_t *samples, int *num_samples) {
+    audio_source_t *source = audio_source_open(source_spec, SAMPLE_RATE);
+    if (!source) {
         return false;
     }
 
-    // Skip WAV header
-    fseek(file, 44, SEEK_SET);
-
-    // Read audio samples (16-bit signed integers)
-    int16_t buffer[N];
-    *num_samples = fread(buffer, sizeof(int16_t), N, file);
-    fclose(file);
+    // Read audio samples (mono doubles in [-1, 1) from any backend)
+    double buffer[N];
+    *num_samples = audio_source_read_block(source, buffer, N);
+    audio_source_close(source);
+    if (*num_samples < 0) {
+        printf("Error: Unable to read file.\n");
+        return false;
+    }
 
-    // Convert samples to fixed-point representation
+    // Convert samples to fixed-point representation (exact for 16-bit sources)
     for (int i = 0; i < *num_samples; i++) {
-        samples[i] = (fixed_point_t)buffer[i] << FRACTIONAL_BITS;
+        samples[i] = (fixed_point_t)lrint(buffer[i] * (1 << (15 + FRACTIONAL_BITS)));
     }
 
     // Zero out the remaining elements in the samples array
@@ -131,7 +105,8 @@ void write_wav_file(const char *filename, int16_t *samples, int num_samples, int
     fclose(file);
 }
 
-int main() {
+// Usage: FFTint [source] (see audio_source.h)
+int main(int argc, char *argv[]) {
     // Example usage
     complex double x[N]; // Input sequence
     fixed_point_t samples[N]; // Array to store audio samples
@@ -139,27 +114,47 @@ int main() {
     int num_samples;
 
     // Read audio file
-    if (!read_audio(FILENAME, samples, &num_samples)) {
+    if (!read_audio(argc > 1 ? argv[1] : FILENAME, samples, &num_samples)) {
         return 1;
     }
     
 
-    // Convert samples to complex array
+    // Convert samples to Q15 (the 16-bit PCM value in the integer bits)
+    static fft_q15_t x_q15[N], x_ref[N];
     for (int i = 0; i < N; i++) {
-        x[i] = fixed_to_double(samples[i]);
+        x_q15[i].re = (int16_t)(samples[i] >> FRACTIONAL_BITS);
+        x_q15[i].im = 0;
+        x_ref[i] = x_q15[i];
     }
     
 
-    // Perform FFT
-    fft(x, N, 1);
+    // Create forward and inverse plans once
+    fft_plan_t *forward_plan = fft_plan_create(N, FFT_FORWARD, FFT_PRECISION_Q15);
+    fft_plan_t *inverse_plan = fft_plan_create(N, FFT_INVERSE, FFT_PRECISION_DOUBLE);
+    if (!forward_plan || !inverse_plan) {
+        printf("Error: Unable to create FFT plan.\n");
+        return 1;
+    }
+
+    // Perform integer FFT and check it against the bit-exact reference
+    int exponent = fft_plan_execute_q15(forward_plan, x_q15);
+    int ref_exponent = fft_q15_reference(x_ref, N, FFT_FORWARD);
+    if (exponent != ref_exponent || memcmp(x_q15, x_ref, sizeof(x_q15)) != 0) {
+        printf("Error: Q15 FFT does not match the reference.\n");
+    }
+
+    // Scale by the block exponent back into PCM units for the inverse transform
+    for (int i = 0; i < N; i++) {
+        x[i] = ldexp(x_q15[i].re, exponent) + I * ldexp(x_q15[i].im, exponent);
+    }
 
     // Print results
-    printf("FFT result:\n");
+    printf("FFT result (block exponent %d):\n", exponent);
     //for (int i = 0; i < N; i++) {
     //    printf("%.2f + %.2fi\n", creal(x[i]), cimag(x[i]));
     //}
     
-    ifft(x, N, 1); // Assuming x contains the frequency-domain data
+    ifft(inverse_plan, x, N); // Assuming x contains the frequency-domain data
 
     // Convert the samples to integers if necessary
     for (int i = 0; i < N*SAMPLE_RATE; i++) {
@@ -169,5 +164,7 @@ int main() {
     // Write the time-domain samples to a WAV file
     write_wav_file("output.wav", time_domain_samples, N*SAMPLE_RATE, SAMPLE_RATE);
 
+    fft_plan_destroy(forward_plan);
+    fft_plan_destroy(inverse_plan);
     return 0;
 }
@@ -31,6 +31,18 @@
 #include <linux/of_address.h>
 #include <linux/fs.h>
 #include <linux/uaccess.h>
+#include <linux/vmalloc.h>
+#include <linux/mm.h>
+#include <linux/hrtimer.h>
+#include <linux/ktime.h>
+#include <linux/wait.h>
+#include <linux/poll.h>
+#include <linux/sched.h>
+#include <linux/spinlock.h>
+#include <linux/atomic.h>
+#include <linux/device.h>
+#include <linux/math64.h>
+#include <linux/uio_driver.h>
 #include "audio_ioctl.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -52,6 +64,14 @@
 //Definte Driver
 #define DRIVER_NAME "audio_data"
 
+static unsigned int sample_rate = SAMPLE_RATE;
+module_param(sample_rate, uint, 0444);
+MODULE_PARM_DESC(sample_rate, "Rate at which the sample register is moved into the ring (Hz)");
+
+static bool uio;
+module_param(uio, bool, 0444);
+MODULE_PARM_DESC(uio, "Export the registers through UIO and leave sampling to userspace");
+
 /* Device registers */
 #define BG_DATA(x) (x)
 
@@ -69,6 +89,23 @@ struct audio_data_dev {
 	void __iomem *virtbase; /* Where registers can be accessed in memory */
         audio_data_t background;
         vga_ball_color_t background1;
+	void *ring;			/* vmalloc_user(): header page + samples, mmap()able */
+	audio_ring_header_t *ring_header;
+	unsigned char *ring_data;
+	u32 *ring_ticks;		/* low 32 bits of each slot's sample clock tick */
+	atomic64_t ticks;		/* tick of the next sample */
+	ktime_t clock_start;		/* time of tick 0 */
+	struct hrtimer sample_timer;	/* sample clock for the data register */
+	struct uio_info uio;		/* UIO mode: register window and block events */
+	ktime_t sample_period;
+	wait_queue_head_t wait;		/* readers waiting for the watermark */
+	u32 watermark;			/* samples buffered before readers are woken */
+	atomic64_t wake_ns;		/* when the sample clock last woke the readers */
+	atomic_t wake_pending;		/* that wakeup has not been observed yet */
+	spinlock_t stats_lock;		/* wakeup latency statistics below */
+	u64 wakeups;
+	u64 wake_latency_total_ns;
+	u64 wake_latency_max_ns;
 } dev;
 
 /*
@@ -99,6 +136,194 @@ static void write_background_video(vga_ball_color_t *background1)
 }
 
 
+/*
+ * Sample clock: move the current sample from the register into the ring.
+ * Only this function writes head; the reader only writes tail.
+ */
+static enum hrtimer_restart audio_data_sample(struct hrtimer *timer)
+{
+	audio_ring_header_t *header = dev.ring_header;
+	u32 head = header->head;
+	u32 tail = smp_load_acquire(&header->tail);
+
+	if (head - tail >= AUDIO_RING_SAMPLES) {
+		WRITE_ONCE(header->overruns, header->overruns + 1);
+	} else {
+		dev.ring_data[head & (AUDIO_RING_SAMPLES - 1)] = ioread32(BG_DATA(dev.virtbase));
+		dev.ring_ticks[head & (AUDIO_RING_SAMPLES - 1)] = (u32)atomic64_read(&dev.ticks);
+		/* Publish the sample before the index that covers it */
+		smp_store_release(&header->head, head + 1);
+
+		/* Wake readers once, when the buffered count reaches the watermark */
+		if (head + 1 - tail == READ_ONCE(dev.watermark)) {
+			atomic64_set(&dev.wake_ns, ktime_get_ns());
+			atomic_set(&dev.wake_pending, 1);
+			wake_up_interruptible(&dev.wait);
+		}
+	}
+
+	/* Periods the timer missed are samples never taken: they show as a tick gap */
+	atomic64_add(hrtimer_forward_now(timer, dev.sample_period), &dev.ticks);
+	return HRTIMER_RESTART;
+}
+
+/*
+ * UIO mode clock: no per-sample work in the kernel, one event every
+ * watermark sample periods to pace the userspace reader
+ */
+static enum hrtimer_restart audio_data_uio_event(struct hrtimer *timer)
+{
+	uio_event_notify(&dev.uio);
+	hrtimer_forward_now(timer, ktime_set(0, ktime_to_ns(dev.sample_period) * READ_ONCE(dev.watermark)));
+	return HRTIMER_RESTART;
+}
+
+static u32 audio_data_available(void)
+{
+	audio_ring_header_t *header = dev.ring_header;
+
+	return smp_load_acquire(&header->head) - READ_ONCE(header->tail);
+}
+
+/* Account the time from the sample clock's wakeup to the reader running */
+static void audio_data_note_wakeup(void)
+{
+	u64 latency;
+
+	if (!atomic_xchg(&dev.wake_pending, 0))
+		return;
+	latency = ktime_get_ns() - atomic64_read(&dev.wake_ns);
+
+	spin_lock(&dev.stats_lock);
+	dev.wakeups++;
+	dev.wake_latency_total_ns += latency;
+	if (latency > dev.wake_latency_max_ns)
+		dev.wake_latency_max_ns = latency;
+	spin_unlock(&dev.stats_lock);
+}
+
+/*
+ * Wait until the watermark is buffered (or, with O_NONBLOCK, fail with
+ * -EAGAIN when the ring is empty)
+ */
+static int audio_data_wait(struct file *f)
+{
+	if (f->f_flags & O_NONBLOCK) {
+		if (audio_data_available() == 0)
+			return -EAGAIN;
+	} else if (wait_event_interruptible(dev.wait, audio_data_available() >= READ_ONCE(dev.watermark))) {
+		return -ERESTARTSYS;
+	}
+	audio_data_note_wakeup();
+	return 0;
+}
+
+/*
+ * Copy up to count buffered samples from tail with one copy_to_user per
+ * contiguous run, then hand the slots back to the sample clock
+ */
+static ssize_t audio_data_drain(char __user *buf, size_t count, u32 *tail_out)
+{
+	audio_ring_header_t *header = dev.ring_header;
+	u32 tail = READ_ONCE(header->tail);
+	u32 head = smp_load_acquire(&header->head);
+	u32 available = head - tail;
+	size_t first;
+
+	/*
+	 * tail is writable through mmap(): more than a ring's worth outstanding
+	 * means userspace corrupted it. Drop the buffered samples and resync.
+	 */
+	if (available > AUDIO_RING_SAMPLES) {
+		smp_store_release(&header->tail, head);
+		return -EINVAL;
+	}
+	if (count > available)
+		count = available;
+	if (count > AUDIO_RING_SAMPLES)
+		count = AUDIO_RING_SAMPLES;
+
+	first = min_t(size_t, count, AUDIO_RING_SAMPLES - (tail & (AUDIO_RING_SAMPLES - 1)));
+	if (copy_to_user(buf, dev.ring_data + (tail & (AUDIO_RING_SAMPLES - 1)), first))
+		return -EFAULT;
+	if (count > first && copy_to_user(buf + first, dev.ring_data, count - first))
+		return -EFAULT;
+
+	*tail_out = tail;
+	/* Only after the copy: the slots may be overwritten from here on */
+	smp_store_release(&header->tail, tail + count);
+	return count;
+}
+
+/* Drain up to count buffered samples; blocks until the watermark is reached */
+static ssize_t audio_data_read(struct file *f, char __user *buf, size_t count, loff_t *offset)
+{
+	u32 tail;
+	int ret;
+
+	if (count == 0)
+		return 0;
+	ret = audio_data_wait(f);
+	if (ret)
+		return ret;
+	return audio_data_drain(buf, count, &tail);
+}
+
+/* Fill a user audio_data_bulk_t: its samples, first tick and that tick's time */
+static long audio_data_read_bulk(struct file *f, audio_data_bulk_t __user *arg)
+{
+	u32 count, tail, tick_low;
+	u64 ticks, sequence;
+	ssize_t copied;
+	int ret;
+
+	if (get_user(count, &arg->count))
+		return -EFAULT;
+	if (count == 0 || count > AUDIO_BULK_SAMPLES)
+		count = AUDIO_BULK_SAMPLES;
+	ret = audio_data_wait(f);
+	if (ret)
+		return ret;
+
+	/* Read the tick of the first sample before its slot is handed back */
+	tail = READ_ONCE(dev.ring_header->tail);
+	tick_low = dev.ring_ticks[tail & (AUDIO_RING_SAMPLES - 1)];
+	ticks = atomic64_read(&dev.ticks);
+	copied = audio_data_drain((char __user *)arg->data, count, &tail);
+	if (copied < 0)
+		return copied;
+
+	/* The sample is less than 2^32 ticks old: extend its tick from the current one */
+	sequence = ticks - (u32)((u32)ticks - tick_low);
+	if (put_user(sequence, &arg->sequence) ||
+	    put_user(ktime_to_ns(ktime_add_ns(dev.clock_start, sequence * ktime_to_ns(dev.sample_period))),
+		     &arg->timestamp_ns) ||
+	    put_user((u32)copied, &arg->count) ||
+	    put_user(READ_ONCE(dev.ring_header->overruns), &arg->overruns))
+		return -EFAULT;
+	return 0;
+}
+
+/* Readable once the watermark is reached */
+static __poll_t audio_data_poll(struct file *f, poll_table *wait)
+{
+	poll_wait(f, &dev.wait, wait);
+	if (audio_data_available() >= READ_ONCE(dev.watermark)) {
+		audio_data_note_wakeup();
+		return EPOLLIN | EPOLLRDNORM;
+	}
+	return 0;
+}
+
+/* Map the header page and the samples; the reader then advances tail itself */
+static int audio_data_mmap(struct file *f, struct vm_area_struct *vma)
+{
+	if (vma->vm_pgoff != 0 ||
+	    vma->vm_end - vma->vm_start > PAGE_ALIGN(AUDIO_RING_MAP_SIZE))
+		return -EINVAL;
+	return remap_vmalloc_range(vma, dev.ring, 0);
+}
+
 /*
  * Handle ioctl() calls from userspace:
  * Read or write the segments on single digits.
@@ -160,6 +385,17 @@ static long audio_data_ioctl(struct file *f, unsigned int cmd, unsigned long arg
 			write_background_video(&vla2.background1);
 		break;
 
+		case AUDIO_DATA_SET_WATERMARK:
+			if (arg == 0 || arg > AUDIO_RING_SAMPLES)
+				return -EINVAL;
+			WRITE_ONCE(dev.watermark, (u32)arg);
+			/* Readers may already be satisfied by the new level */
+			wake_up_interruptible(&dev.wait);
+			break;
+
+		case AUDIO_DATA_READ_BULK:
+			return audio_data_read_bulk(f, (audio_data_bulk_t __user *) arg);
+
 		case AUDIO_DATA_READ:
 			vla2.background1 = dev.background1;
 	  		vla.background = dev.background;
@@ -193,13 +429,74 @@ static long audio_data_ioctl(struct file *f, unsigned int cmd, unsigned long arg
 static const struct file_operations audio_data_fops = {
 	.owner		= THIS_MODULE,
 	.unlocked_ioctl = audio_data_ioctl,
+	.read		= audio_data_read,
+	.poll		= audio_data_poll,
+	.mmap		= audio_data_mmap,
 };
 
+/*
+ * sysfs (/sys/class/misc/audio_data/): the watermark, and how long readers
+ * took to run after the sample clock woke them
+ */
+static ssize_t watermark_show(struct device *d, struct device_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%u\n", READ_ONCE(dev.watermark));
+}
+
+static ssize_t watermark_store(struct device *d, struct device_attribute *attr,
+			       const char *buf, size_t count)
+{
+	u32 watermark;
+
+	if (kstrtou32(buf, 0, &watermark) || watermark == 0 || watermark > AUDIO_RING_SAMPLES)
+		return -EINVAL;
+	WRITE_ONCE(dev.watermark, watermark);
+	wake_up_interruptible(&dev.wait);
+	return count;
+}
+static DEVICE_ATTR_RW(watermark);
+
+static ssize_t wakeup_latency_show(struct device *d, struct device_attribute *attr, char *buf)
+{
+	u64 wakeups, total, max;
+
+	spin_lock(&dev.stats_lock);
+	wakeups = dev.wakeups;
+	total = dev.wake_latency_total_ns;
+	max = dev.wake_latency_max_ns;
+	spin_unlock(&dev.stats_lock);
+
+	return sprintf(buf, "wakeups %llu\navg_ns %llu\nmax_ns %llu\noverruns %u\n",
+		       wakeups, wakeups ? div64_u64(total, wakeups) : 0, max,
+		       READ_ONCE(dev.ring_header->overruns));
+}
+
+/* Writing anything resets the latency statistics */
+static ssize_t wakeup_latency_store(struct device *d, struct device_attribute *attr,
+				    const char *buf, size_t count)
+{
+	spin_lock(&dev.stats_lock);
+	dev.wakeups = 0;
+	dev.wake_latency_total_ns = 0;
+	dev.wake_latency_max_ns = 0;
+	spin_unlock(&dev.stats_lock);
+	return count;
+}
+static DEVICE_ATTR_RW(wakeup_latency);
+
+static struct attribute *audio_data_attrs[] = {
+	&dev_attr_watermark.attr,
+	&dev_attr_wakeup_latency.attr,
+	NULL,
+};
+ATTRIBUTE_GROUPS(audio_data);
+
 /* Information about our device for the "misc" framework -- like a char dev */
 static struct miscdevice audio_data_misc_device = {
 	.minor		= MISC_DYNAMIC_MINOR,
 	.name		= DRIVER_NAME,
 	.fops		= &audio_data_fops,
+	.groups		= audio_data_groups,
 };
 
 /*
@@ -215,8 +512,29 @@ static int __init audio_data_probe(struct platform_device *pdev)
         vga_ball_color_t beige1 = { 0xf9, 0xe4, 0xb7, 0x00, 0x00 };
 	int ret;
 
+	if (sample_rate == 0)
+		return -EINVAL;
+
+	/* The ring must exist before the device node can be opened */
+	dev.ring = vmalloc_user(AUDIO_RING_MAP_SIZE);
+	if (dev.ring == NULL)
+		return -ENOMEM;
+	dev.ring_header = dev.ring;
+	dev.ring_header->size = AUDIO_RING_SAMPLES;
+	dev.ring_data = (unsigned char *)dev.ring + AUDIO_RING_DATA_OFFSET;
+	dev.ring_ticks = vmalloc(AUDIO_RING_SAMPLES * sizeof(u32));
+	if (dev.ring_ticks == NULL) {
+		ret = -ENOMEM;
+		goto out_free_ring;
+	}
+	init_waitqueue_head(&dev.wait);
+	spin_lock_init(&dev.stats_lock);
+	dev.watermark = AUDIO_RING_DEFAULT_WATERMARK;
+
 	/* Register ourselves as a misc device: creates /dev/vga_ball */
 	ret = misc_register(&audio_data_misc_device);
+	if (ret)
+		goto out_free_ring;
 
 	/* Get the address of our registers from the device tree */
 	ret = of_address_to_resource(pdev->dev.of_node, 0, &dev.res);
@@ -243,21 +561,59 @@ static int __init audio_data_probe(struct platform_device *pdev)
         write_background_audio(&beige);
         write_background_video(&beige1);
 
+	/*
+	 * Start filling the ring at the sample rate. Expiries stay on the grid
+	 * clock_start + tick * sample_period, which timestamps every sample.
+	 * In UIO mode the timer only raises the block events.
+	 */
+	dev.sample_period = ktime_set(0, NSEC_PER_SEC / sample_rate);
+	atomic64_set(&dev.ticks, 0);
+	dev.clock_start = ktime_add(ktime_get(), dev.sample_period);
+	hrtimer_init(&dev.sample_timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+	dev.sample_timer.function = audio_data_sample;
+
+	if (uio) {
+		dev.uio.name = AUDIO_UIO_NAME;
+		dev.uio.version = "1.0";
+		dev.uio.mem[0].name = "registers";
+		/* mmap works in whole pages: user space adds maps/map0/offset */
+		dev.uio.mem[0].addr = dev.res.start & PAGE_MASK;
+		dev.uio.mem[0].offs = dev.res.start & ~PAGE_MASK;
+		dev.uio.mem[0].size = PAGE_ALIGN(dev.uio.mem[0].offs + resource_size(&dev.res));
+		dev.uio.mem[0].memtype = UIO_MEM_PHYS;
+		dev.uio.irq = UIO_IRQ_CUSTOM;
+		ret = uio_register_device(&pdev->dev, &dev.uio);
+		if (ret)
+			goto out_iounmap;
+		dev.sample_timer.function = audio_data_uio_event;
+	}
+	hrtimer_start(&dev.sample_timer, dev.clock_start, HRTIMER_MODE_ABS);
+
 	return 0;
 
+out_iounmap:
+	iounmap(dev.virtbase);
 out_release_mem_region:
 	release_mem_region(dev.res.start, resource_size(&dev.res));
 out_deregister:
 	misc_deregister(&audio_data_misc_device);
+out_free_ring:
+	vfree(dev.ring_ticks);
+	vfree(dev.ring);
 	return ret;
 }
 
 /* Clean-up code: release resources */
 static int audio_data_remove(struct platform_device *pdev)
 {
+	hrtimer_cancel(&dev.sample_timer);
+	if (uio)
+		uio_unregister_device(&dev.uio);
 	iounmap(dev.virtbase);
 	release_mem_region(dev.res.start, resource_size(&dev.res));
 	misc_deregister(&audio_data_misc_device);
+	vfree(dev.ring_ticks);
+	vfree(dev.ring);
 	return 0;
 }
 
@@ -2,6 +2,7 @@
 #define _AUDIO_BUS_H
 
 #include <linux/ioctl.h>
+#include <linux/types.h>
 
 typedef struct {
 	unsigned char data;
@@ -22,11 +23,60 @@ typedef struct {
 //typedef struct {
 //} audio_data_t;
 
+/*
+ * Sample ring shared by the driver and userspace. The driver appends samples
+ * at head; the reader consumes at tail, either with read() (the driver
+ * advances tail) or by mmap()ing AUDIO_RING_MAP_SIZE bytes at offset 0 and
+ * advancing tail itself. Both indices run freely and wrap at 2^32; the
+ * sample for index i is at data[i % AUDIO_RING_SAMPLES]. One reader at a time.
+ */
+#define AUDIO_RING_SAMPLES 65536 /* power of two */
+#define AUDIO_RING_DATA_OFFSET 4096 /* header page, then samples */
+#define AUDIO_RING_MAP_SIZE (AUDIO_RING_DATA_OFFSET + AUDIO_RING_SAMPLES)
+#define AUDIO_RING_DEFAULT_WATERMARK 4096 /* one analysis frame */
+
+typedef struct {
+	__u32 head;     /* samples produced; written by the driver only */
+	__u32 tail;     /* samples consumed; written by the reader only */
+	__u32 size;     /* AUDIO_RING_SAMPLES */
+	__u32 overruns; /* samples dropped because the ring was full */
+} audio_ring_header_t;
+
+/*
+ * AUDIO_DATA_READ_BULK: up to AUDIO_BULK_SAMPLES samples from the ring in one
+ * call, with the sample clock tick of the first one. Ticks count every period
+ * of the sample clock, so a sequence that does not continue the previous
+ * block's (sequence + count) means samples were dropped in between.
+ */
+#define AUDIO_BULK_SAMPLES 4096 /* one analysis frame */
+
+typedef struct {
+	__u64 sequence;     /* sample clock tick of data[0] */
+	__s64 timestamp_ns; /* CLOCK_MONOTONIC time of that tick */
+	__u32 count;        /* in: samples wanted (at most AUDIO_BULK_SAMPLES); out: samples returned */
+	__u32 overruns;     /* the ring's overrun counter */
+	audio_data_t data[AUDIO_BULK_SAMPLES];
+} audio_data_bulk_t;
+
+/*
+ * UIO mode (module parameter uio=1): the register window is exported as map 0
+ * of a UIO device named AUDIO_UIO_NAME and the driver stops sampling. Userspace
+ * loads the data register itself; read() of a __u32 on /dev/uioN blocks until
+ * the next event, one every watermark sample periods, and returns the event
+ * count so far.
+ */
+#define AUDIO_UIO_NAME "audio_data"
+#define AUDIO_UIO_DATA_REG 0 /* 32-bit word offset of the data register in map 0 */
+
 #define AUDIO_DISPLAY_MAGIC 'q'
 
 /* ioctls and their arguments */
 #define AUDIO_DATA_WRITE _IOW(AUDIO_DISPLAY_MAGIC, 1, audio_data_arg_t *)
 #define AUDIO_DATA_READ _IOR(AUDIO_DISPLAY_MAGIC, 2, audio_data_arg_t *)
 //#define AUDIO_DATA_VISUALIZE _IOW(AUDIO_DISPLAY_MAGIC, 3, audio_data_arg_t *) // New IOCTL command
+/* poll()/blocking read() readiness: at least this many samples buffered (1 .. AUDIO_RING_SAMPLES) */
+#define AUDIO_DATA_SET_WATERMARK _IOW(AUDIO_DISPLAY_MAGIC, 4, __u32)
+/* Blocks like read() until the watermark is buffered, unless O_NONBLOCK */
+#define AUDIO_DATA_READ_BULK _IOWR(AUDIO_DISPLAY_MAGIC, 5, audio_data_bulk_t)
 
 #endif
@@ -0,0 +1,283 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "audio_ring.h"
+
+#define SIM_TICK_NS 1000000 // simulated device: samples are produced in 1 ms batches
+
+// The driver publishes head with a release store and reads tail with an
+// acquire load; the userspace side mirrors it with the same orderings
+static unsigned int load_acquire(const __u32 *index) {
+    return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+}
+
+static void store_release(__u32 *index, unsigned int value) {
+    __atomic_store_n(index, value, __ATOMIC_RELEASE);
+}
+
+static audio_ring_t *ring_alloc(void) {
+    audio_ring_t *ring = calloc(1, sizeof(*ring));
+    if (ring) {
+        ring->fd = -1;
+        ring->epoll_fd = -1;
+        ring->event_fd = -1;
+        ring->watermark = 1;
+        ring->map = MAP_FAILED;
+    }
+    return ring;
+}
+
+// Function to register fd for readability with a new epoll instance
+static bool ring_watch(audio_ring_t *ring, int fd) {
+    struct epoll_event event = {.events = EPOLLIN, .data.fd = fd};
+    ring->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (ring->epoll_fd < 0 || epoll_ctl(ring->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        printf("Error: Unable to watch the audio ring.\n");
+        return false;
+    }
+    return true;
+}
+
+// Function to map the driver's ring
+audio_ring_t *audio_ring_open(int fd) {
+    audio_ring_t *ring = ring_alloc();
+    if (!ring) {
+        return NULL;
+    }
+    ring->fd = fd;
+    ring->map = mmap(NULL, AUDIO_RING_MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ring->map == MAP_FAILED) {
+        printf("Error: Unable to map the audio ring.\n");
+        free(ring);
+        return NULL;
+    }
+    ring->header = ring->map;
+    ring->data = (const unsigned char *)ring->map + AUDIO_RING_DATA_OFFSET;
+    if (ring->header->size != AUDIO_RING_SAMPLES) {
+        printf("Error: Audio ring size mismatch (driver %u, expected %d).\n", ring->header->size, AUDIO_RING_SAMPLES);
+        audio_ring_close(ring);
+        return NULL;
+    }
+    // The driver's poll() reports readable once its watermark is buffered
+    if (!ring_watch(ring, fd) || !audio_ring_set_watermark(ring, AUDIO_RING_DEFAULT_WATERMARK)) {
+        audio_ring_close(ring);
+        return NULL;
+    }
+    return ring;
+}
+
+// Simulated sample clock: the same producer logic as the driver's timer
+static void *simulated_producer(void *arg) {
+    audio_ring_t *ring = arg;
+    audio_ring_header_t *header = ring->header;
+    unsigned char *data = (unsigned char *)ring->data;
+    double phase = 0.0;
+    double step = 2 * M_PI * ring->frequency / ring->sample_rate;
+    long long produced = 0; // sample clock ticks, dropped samples included
+    struct timespec start = {ring->start_ns / 1000000000LL, ring->start_ns % 1000000000LL};
+    struct timespec next = start;
+
+    while (atomic_load(&ring->running)) {
+        next.tv_nsec += SIM_TICK_NS;
+        if (next.tv_nsec >= 1000000000) {
+            next.tv_nsec -= 1000000000;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+        // Catch up to real time, so a late wakeup produces a bigger batch
+        long long elapsed_ns = (next.tv_sec - start.tv_sec) * 1000000000LL + (next.tv_nsec - start.tv_nsec);
+        long long due = elapsed_ns * ring->sample_rate / 1000000000LL;
+        unsigned int before = header->head - load_acquire(&header->tail);
+        for (; produced < due; produced++) {
+            unsigned int head = header->head;
+            if (head - load_acquire(&header->tail) >= AUDIO_RING_SAMPLES) {
+                __atomic_store_n(&header->overruns, header->overruns + 1, __ATOMIC_RELAXED);
+            } else {
+                data[head & (AUDIO_RING_SAMPLES - 1)] = (unsigned char)lrint(128 + 100 * sin(phase));
+                ring->ticks[head & (AUDIO_RING_SAMPLES - 1)] = produced;
+                store_release(&header->head, head + 1);
+            }
+            phase += step;
+            if (phase >= 2 * M_PI) {
+                phase -= 2 * M_PI;
+            }
+        }
+
+        // Like the driver's wait queue: signal once, when the batch crosses the watermark
+        unsigned int watermark = __atomic_load_n(&ring->watermark, __ATOMIC_RELAXED);
+        unsigned int after = header->head - load_acquire(&header->tail);
+        if (before < watermark && after >= watermark) {
+            uint64_t one = 1;
+            if (write(ring->event_fd, &one, sizeof(one)) < 0) {
+                // Counter saturated: the waiter is already signalled
+            }
+        }
+    }
+    return NULL;
+}
+
+// Function to create a simulated device with the driver's ring layout
+audio_ring_t *audio_ring_open_simulated(int sample_rate, double frequency) {
+    if (sample_rate < 1) {
+        return NULL;
+    }
+    audio_ring_t *ring = ring_alloc();
+    if (!ring) {
+        return NULL;
+    }
+    ring->map = mmap(NULL, AUDIO_RING_MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (ring->map == MAP_FAILED) {
+        free(ring);
+        return NULL;
+    }
+    ring->header = ring->map;
+    ring->header->size = AUDIO_RING_SAMPLES;
+    ring->data = (const unsigned char *)ring->map + AUDIO_RING_DATA_OFFSET;
+    ring->sample_rate = sample_rate;
+    ring->frequency = frequency;
+    ring->watermark = AUDIO_RING_DEFAULT_WATERMARK;
+    ring->ticks = malloc(AUDIO_RING_SAMPLES * sizeof(uint64_t));
+    if (!ring->ticks) {
+        audio_ring_close(ring);
+        return NULL;
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    ring->start_ns = now.tv_sec * 1000000000LL + now.tv_nsec;
+    ring->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (ring->event_fd < 0 || !ring_watch(ring, ring->event_fd)) {
+        audio_ring_close(ring);
+        return NULL;
+    }
+    atomic_init(&ring->running, 1);
+    if (pthread_create(&ring->producer, NULL, simulated_producer, ring) != 0) {
+        atomic_store(&ring->running, 0);
+        audio_ring_close(ring);
+        return NULL;
+    }
+    return ring;
+}
+
+unsigned int audio_ring_available(const audio_ring_t *ring) {
+    return load_acquire(&ring->header->head) - ring->header->tail;
+}
+
+// Function to copy samples out of the shared ring
+int audio_ring_read(audio_ring_t *ring, audio_data_t *out, int count) {
+    audio_ring_header_t *header = ring->header;
+    unsigned int tail = header->tail;
+    unsigned int available = load_acquire(&header->head) - tail;
+    if ((unsigned int)count > available) {
+        count = (int)available;
+    }
+
+    // At most two contiguous runs: up to the end of the ring, then from its start
+    unsigned int offset = tail & (AUDIO_RING_SAMPLES - 1);
+    int first = count < (int)(AUDIO_RING_SAMPLES - offset) ? count : (int)(AUDIO_RING_SAMPLES - offset);
+    memcpy(out, ring->data + offset, first * sizeof(audio_data_t));
+    memcpy(out + first, ring->data, (count - first) * sizeof(audio_data_t));
+
+    // Release the slots only after the copy
+    store_release(&header->tail, tail + count);
+    return count;
+}
+
+// Function to set the wakeup level, in the driver too when there is one
+bool audio_ring_set_watermark(audio_ring_t *ring, unsigned int samples) {
+    if (samples < 1 || samples > AUDIO_RING_SAMPLES) {
+        printf("Error: Watermark must be 1 to %d samples.\n", AUDIO_RING_SAMPLES);
+        return false;
+    }
+    if (ring->fd >= 0 && ioctl(ring->fd, AUDIO_DATA_SET_WATERMARK, samples) < 0) {
+        perror("ioctl(AUDIO_DATA_SET_WATERMARK) failed");
+        return false;
+    }
+    __atomic_store_n(&ring->watermark, samples, __ATOMIC_RELAXED);
+    return true;
+}
+
+// Function to sleep in epoll until the watermark is buffered
+int audio_ring_wait(audio_ring_t *ring, int timeout_ms) {
+    while (audio_ring_available(ring) < ring->watermark) {
+        struct epoll_event event;
+        int n = epoll_wait(ring->epoll_fd, &event, 1, timeout_ms);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait failed");
+            return -1;
+        }
+        if (n == 0) {
+            return 0;
+        }
+        // Re-arm the simulated device's signal; the driver's poll() is level-triggered
+        if (ring->event_fd >= 0) {
+            uint64_t count;
+            if (read(ring->event_fd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+                return -1;
+            }
+        }
+    }
+    return 1;
+}
+
+// Function to read one timestamped block: the driver's ioctl, or its equivalent
+bool audio_ring_read_bulk(audio_ring_t *ring, audio_data_bulk_t *bulk) {
+    if (ring->fd >= 0) {
+        if (ioctl(ring->fd, AUDIO_DATA_READ_BULK, bulk) < 0) {
+            perror("ioctl(AUDIO_DATA_READ_BULK) failed");
+            return false;
+        }
+        return true;
+    }
+
+    if (bulk->count == 0 || bulk->count > AUDIO_BULK_SAMPLES) {
+        bulk->count = AUDIO_BULK_SAMPLES;
+    }
+    if (audio_ring_wait(ring, -1) < 0) {
+        return false;
+    }
+    // The producer does not reuse the slot before the read releases it
+    uint64_t tick = ring->ticks[ring->header->tail & (AUDIO_RING_SAMPLES - 1)];
+    bulk->count = audio_ring_read(ring, bulk->data, bulk->count);
+    bulk->sequence = tick;
+    bulk->timestamp_ns = ring->start_ns + (long long)(tick / ring->sample_rate) * 1000000000LL +
+                         (long long)(tick % ring->sample_rate) * 1000000000LL / ring->sample_rate;
+    bulk->overruns = audio_ring_overruns(ring);
+    return true;
+}
+
+unsigned int audio_ring_overruns(const audio_ring_t *ring) {
+    return __atomic_load_n(&ring->header->overruns, __ATOMIC_RELAXED);
+}
+
+void audio_ring_close(audio_ring_t *ring) {
+    if (!ring) return;
+    if (ring->fd < 0 && atomic_load(&ring->running)) {
+        atomic_store(&ring->running, 0);
+        pthread_join(ring->producer, NULL);
+    }
+    if (ring->epoll_fd >= 0) {
+        close(ring->epoll_fd);
+    }
+    if (ring->event_fd >= 0) {
+        close(ring->event_fd);
+    }
+    if (ring->map != MAP_FAILED) {
+        munmap(ring->map, AUDIO_RING_MAP_SIZE);
+    }
+    free(ring->ticks);
+    free(ring);
+}
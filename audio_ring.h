@@ -0,0 +1,63 @@
+#ifndef _AUDIO_RING_H
+#define _AUDIO_RING_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "audio_ioctl.h"
+
+// Userspace side of the driver's sample ring (see audio_ioctl.h). The ring is
+// either the driver's, mmap()ed from /dev/audio_data, or a simulated device:
+// the same memory layout filled by a thread at the sample rate, so the capture
+// path runs unchanged without the FPGA.
+typedef struct {
+    int fd;                      // device, or -1 when simulated
+    int epoll_fd;                // waits on the device, or on event_fd when simulated
+    int event_fd;                // simulated device: signalled when the watermark is reached
+    unsigned int watermark;      // samples buffered before audio_ring_wait() returns
+    void *map;
+    audio_ring_header_t *header;
+    const unsigned char *data;
+    // Simulated device only
+    pthread_t producer;
+    atomic_int running;
+    int sample_rate;
+    double frequency;
+    uint64_t *ticks;             // sample clock tick of each slot
+    long long start_ns;          // CLOCK_MONOTONIC time of tick 0
+} audio_ring_t;
+
+// Map the ring of an open /dev/audio_data descriptor; NULL on failure
+audio_ring_t *audio_ring_open(int fd);
+
+// Simulated device producing a sine of frequency Hz at sample_rate; NULL on failure
+audio_ring_t *audio_ring_open_simulated(int sample_rate, double frequency);
+
+// Samples waiting in the ring
+unsigned int audio_ring_available(const audio_ring_t *ring);
+
+// Copy up to count waiting samples out of the ring and release their slots;
+// returns the number copied (0 when empty). Never enters the kernel.
+int audio_ring_read(audio_ring_t *ring, audio_data_t *out, int count);
+
+// Set how many samples must be buffered before audio_ring_wait() returns
+// (1 .. AUDIO_RING_SAMPLES); also the driver's poll() and read() wakeup level
+bool audio_ring_set_watermark(audio_ring_t *ring, unsigned int samples);
+
+// Block until at least the watermark is buffered: 1 when it is, 0 when
+// timeout_ms (-1: none) passes first, -1 on error
+int audio_ring_wait(audio_ring_t *ring, int timeout_ms);
+
+// Like the driver's AUDIO_DATA_READ_BULK: wait for the watermark, then fill
+// bulk with up to bulk->count samples (0: AUDIO_BULK_SAMPLES), the tick of
+// the first and its CLOCK_MONOTONIC time. false on error.
+bool audio_ring_read_bulk(audio_ring_t *ring, audio_data_bulk_t *bulk);
+
+// Samples the producer dropped because the ring was full
+unsigned int audio_ring_overruns(const audio_ring_t *ring);
+
+void audio_ring_close(audio_ring_t *ring);
+
+#endif
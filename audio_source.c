@@ -0,0 +1,274 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "audio_source.h"
+
+#define AUDIO_DEVICE_PATH "/dev/audio_data"
+#define SYNTH_SEED 0x9E3779B97F4A7C15ULL
+
+static audio_source_t *source_alloc(audio_source_type_t type, int sample_rate) {
+    audio_source_t *source = calloc(1, sizeof(*source));
+    if (source) {
+        source->type = type;
+        source->sample_rate = sample_rate;
+        source->device_fd = -1;
+    }
+    return source;
+}
+
+// Function to open a WAV file backend
+audio_source_t *audio_source_open_wav(const char *filename) {
+    wav_reader_t *wav = wav_open(filename, 0);
+    if (!wav) {
+        printf("Error: Unable to open file.\n");
+        return NULL;
+    }
+    audio_source_t *source = source_alloc(AUDIO_SOURCE_WAV, wav->format.sample_rate);
+    if (!source) {
+        wav_close(wav);
+        return NULL;
+    }
+    source->wav = wav;
+    return source;
+}
+
+// Function to open a device backend over an already mapped ring
+audio_source_t *audio_source_open_device(audio_ring_t *ring, int sample_rate) {
+    if (!ring) {
+        return NULL;
+    }
+    audio_source_t *source = source_alloc(AUDIO_SOURCE_DEVICE, sample_rate);
+    if (!source) {
+        audio_ring_close(ring);
+        return NULL;
+    }
+    source->ring = ring;
+    return source;
+}
+
+// Function to open a synthetic backend
+audio_source_t *audio_source_open_synth(int sample_rate, const audio_tone_t tones[], int num_tones,
+                                        double noise, double seconds) {
+    if (sample_rate < 1 || num_tones < 0 || num_tones > AUDIO_SOURCE_MAX_TONES) {
+        printf("Error: Invalid synthetic source (at most %d tones).\n", AUDIO_SOURCE_MAX_TONES);
+        return NULL;
+    }
+    audio_source_t *source = source_alloc(AUDIO_SOURCE_SYNTH, sample_rate);
+    if (!source) {
+        return NULL;
+    }
+    source->num_tones = num_tones;
+    for (int t = 0; t < num_tones; t++) {
+        double step = 2 * M_PI * tones[t].frequency / sample_rate;
+        source->tones[t] = tones[t];
+        source->phasor_re[t] = 1.0;
+        source->phasor_im[t] = 0.0;
+        source->rotate_re[t] = cos(step);
+        source->rotate_im[t] = sin(step);
+    }
+    source->noise = noise;
+    source->rng = SYNTH_SEED;
+    source->remaining = seconds > 0 ? (long long)(seconds * sample_rate) : -1;
+    return source;
+}
+
+// Function to parse "f[@amp][+f[@amp]...][,noise=amp][,seconds=s]"
+static audio_source_t *open_synth_spec(const char *spec, int sample_rate) {
+    audio_tone_t tones[AUDIO_SOURCE_MAX_TONES];
+    int num_tones = 0;
+    double noise = 0.0, seconds = 0.0;
+    const char *p = spec;
+    char *end;
+
+    while (*p && *p != ',') {
+        if (num_tones == AUDIO_SOURCE_MAX_TONES) {
+            printf("Error: At most %d synthetic tones.\n", AUDIO_SOURCE_MAX_TONES);
+            return NULL;
+        }
+        tones[num_tones].frequency = strtod(p, &end);
+        tones[num_tones].amplitude = -1.0; // shared out below
+        if (end == p) {
+            break;
+        }
+        p = end;
+        if (*p == '@') {
+            tones[num_tones].amplitude = strtod(p + 1, &end);
+            p = end;
+        }
+        num_tones++;
+        if (*p == '+') {
+            p++;
+        }
+    }
+    while (*p == ',') {
+        p++;
+        if (strncmp(p, "noise=", 6) == 0) {
+            noise = strtod(p + 6, &end);
+        } else if (strncmp(p, "seconds=", 8) == 0) {
+            seconds = strtod(p + 8, &end);
+        } else {
+            break;
+        }
+        p = end;
+    }
+    if (*p != '\0') {
+        printf("Error: Bad synthetic source near \"%s\".\n", p);
+        return NULL;
+    }
+
+    // Tones without an amplitude share half of full scale
+    for (int t = 0; t < num_tones; t++) {
+        if (tones[t].amplitude < 0.0) {
+            tones[t].amplitude = 0.5 / num_tones;
+        }
+    }
+    return audio_source_open_synth(sample_rate, tones, num_tones, noise, seconds);
+}
+
+// Function to open a source from its description
+audio_source_t *audio_source_open(const char *spec, int sample_rate) {
+    if (strncmp(spec, "synth:", 6) == 0) {
+        return open_synth_spec(spec + 6, sample_rate);
+    }
+    if (strcmp(spec, "device:sim") == 0) {
+        return audio_source_open_device(audio_ring_open_simulated(sample_rate, 440.0), sample_rate);
+    }
+    if (strcmp(spec, "device") == 0 || strncmp(spec, "device:", 7) == 0) {
+        const char *path = spec[6] == ':' ? spec + 7 : AUDIO_DEVICE_PATH;
+        int fd = open(path, O_RDWR);
+        if (fd < 0) {
+            perror("could not open audio device");
+            return NULL;
+        }
+        audio_source_t *source = audio_source_open_device(audio_ring_open(fd), sample_rate);
+        if (!source) {
+            close(fd);
+            return NULL;
+        }
+        source->device_fd = fd;
+        return source;
+    }
+
+    // The caller's bins and hop times assume sample_rate: a WAV file must match it
+    audio_source_t *source = audio_source_open_wav(spec);
+    if (source && source->sample_rate != sample_rate) {
+        printf("Error: Sample rate is %d Hz; the analysis expects %d Hz.\n", source->sample_rate, sample_rate);
+        audio_source_close(source);
+        return NULL;
+    }
+    return source;
+}
+
+// Function to make sure a conversion buffer holds count elements
+static void *reserve(void *buffer, int *size, int count, size_t element_size) {
+    if (count <= *size) {
+        return buffer;
+    }
+    void *grown = realloc(buffer, count * element_size);
+    if (grown) {
+        *size = count;
+    }
+    return grown;
+}
+
+static int read_wav(audio_source_t *source, double out[], int max_samples) {
+    int16_t *pcm = reserve(source->pcm, &source->pcm_size, max_samples, sizeof(int16_t));
+    if (!pcm) {
+        return -1;
+    }
+    source->pcm = pcm;
+    int count = wav_read_frames(source->wav, pcm, max_samples);
+    for (int i = 0; i < count; i++) {
+        out[i] = pcm[i] / 32768.0;
+    }
+    return count;
+}
+
+static int read_device(audio_source_t *source, double out[], int max_samples) {
+    audio_data_t *raw = reserve(source->raw, &source->raw_size, max_samples, sizeof(audio_data_t));
+    if (!raw) {
+        return -1;
+    }
+    source->raw = raw;
+    if (audio_ring_wait(source->ring, -1) < 0) {
+        return -1;
+    }
+    int count = audio_ring_read(source->ring, raw, max_samples);
+    for (int i = 0; i < count; i++) {
+        // Unsigned 8-bit device samples are centred on 128
+        out[i] = (raw[i].data - 128) / 128.0;
+    }
+    return count;
+}
+
+// Tones by phasor rotation: two multiply-adds per tone and sample, no libm
+static int read_synth(audio_source_t *source, double out[], int max_samples) {
+    int count = max_samples;
+    if (source->remaining >= 0 && count > source->remaining) {
+        count = (int)source->remaining;
+    }
+
+    // Uniform noise from xorshift64, scaled to [-noise, noise)
+    double noise_scale = source->noise * 0x1p-52;
+    uint64_t rng = source->rng;
+    for (int i = 0; i < count; i++) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        out[i] = noise_scale * ((double)(rng >> 11) - 0x1p52);
+    }
+    source->rng = rng;
+
+    for (int t = 0; t < source->num_tones; t++) {
+        double re = source->phasor_re[t], im = source->phasor_im[t];
+        double rot_re = source->rotate_re[t], rot_im = source->rotate_im[t];
+        double amplitude = source->tones[t].amplitude;
+        for (int i = 0; i < count; i++) {
+            out[i] += amplitude * im;
+            double next_re = re * rot_re - im * rot_im;
+            im = re * rot_im + im * rot_re;
+            re = next_re;
+        }
+        // Rounding drifts the phasor off the unit circle; pull it back once per block
+        double norm = 1.0 / sqrt(re * re + im * im);
+        source->phasor_re[t] = re * norm;
+        source->phasor_im[t] = im * norm;
+    }
+
+    if (source->remaining >= 0) {
+        source->remaining -= count;
+    }
+    return count;
+}
+
+// Function to read the next block from whichever backend
+int audio_source_read_block(audio_source_t *source, double out[], int max_samples) {
+    if (max_samples <= 0) {
+        return 0;
+    }
+    switch (source->type) {
+        case AUDIO_SOURCE_WAV:
+            return read_wav(source, out, max_samples);
+        case AUDIO_SOURCE_DEVICE:
+            return read_device(source, out, max_samples);
+        case AUDIO_SOURCE_SYNTH:
+            return read_synth(source, out, max_samples);
+    }
+    return -1;
+}
+
+void audio_source_close(audio_source_t *source) {
+    if (!source) return;
+    wav_close(source->wav);
+    audio_ring_close(source->ring);
+    if (source->device_fd >= 0) {
+        close(source->device_fd);
+    }
+    free(source->pcm);
+    free(source->raw);
+    free(source);
+}
@@ -0,0 +1,76 @@
+#ifndef _AUDIO_SOURCE_H
+#define _AUDIO_SOURCE_H
+
+#include <stdint.h>
+
+#include "wav_reader.h"
+#include "audio_ring.h"
+
+#define AUDIO_SOURCE_MAX_TONES 8
+
+// Where the samples of an audio_source_t come from
+typedef enum {
+    AUDIO_SOURCE_WAV,    // a WAV file, mixed down to mono
+    AUDIO_SOURCE_DEVICE, // the driver's sample ring (or its simulation)
+    AUDIO_SOURCE_SYNTH   // generated tones plus white noise, as fast as the CPU allows
+} audio_source_type_t;
+
+typedef struct {
+    double frequency; // Hz
+    double amplitude; // peak, of full scale
+} audio_tone_t;
+
+// One stream of mono samples in [-1, 1), whatever the backend
+typedef struct {
+    audio_source_type_t type;
+    int sample_rate;
+    // AUDIO_SOURCE_WAV
+    wav_reader_t *wav;
+    int16_t *pcm;            // conversion buffer
+    int pcm_size;
+    // AUDIO_SOURCE_DEVICE
+    audio_ring_t *ring;
+    int device_fd;           // opened here, or -1
+    audio_data_t *raw;       // conversion buffer
+    int raw_size;
+    // AUDIO_SOURCE_SYNTH
+    int num_tones;
+    audio_tone_t tones[AUDIO_SOURCE_MAX_TONES];
+    double phasor_re[AUDIO_SOURCE_MAX_TONES];  // per-tone exp(i phase), advanced by rotation
+    double phasor_im[AUDIO_SOURCE_MAX_TONES];
+    double rotate_re[AUDIO_SOURCE_MAX_TONES];  // exp(i 2 pi f / sample_rate)
+    double rotate_im[AUDIO_SOURCE_MAX_TONES];
+    double noise;            // peak amplitude of the uniform white noise
+    uint64_t rng;            // xorshift64 state
+    long long remaining;     // samples left to generate, -1 for endless
+} audio_source_t;
+
+// Open a WAV file; NULL on failure
+audio_source_t *audio_source_open_wav(const char *filename);
+
+// Read from an open sample ring (see audio_ring.h), which the source then owns; NULL on failure
+audio_source_t *audio_source_open_device(audio_ring_t *ring, int sample_rate);
+
+// Generate the sum of num_tones tones plus uniform noise of peak amplitude
+// noise, for seconds (<= 0: endless); NULL on failure
+audio_source_t *audio_source_open_synth(int sample_rate, const audio_tone_t tones[], int num_tones,
+                                        double noise, double seconds);
+
+// Open a source from a command-line style description:
+//   path.wav                        a WAV file
+//   device[:path]                   the driver (default /dev/audio_data)
+//   device:sim                      the simulated device, a 440 Hz sine
+//   synth:f[@amp][+f[@amp]...][,noise=amp][,seconds=s]
+//                                   e.g. synth:440+261.63,noise=0.01,seconds=600
+// sample_rate is the rate the caller analyses at: the device and synthetic
+// backends run at it, and a WAV file at any other rate is rejected. NULL on failure
+audio_source_t *audio_source_open(const char *spec, int sample_rate);
+
+// Read up to max_samples samples into out[]. Returns the number read, 0 at
+// the end of the stream, -1 on error. The device backend blocks until the
+// ring's watermark is buffered.
+int audio_source_read_block(audio_source_t *source, double out[], int max_samples);
+
+void audio_source_close(audio_source_t *source);
+
+#endif
@@ -0,0 +1,187 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "audio_uio.h"
+
+#define UIO_MAX_DEVICES 16
+
+static long long now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+// Time of a sample clock tick, exact for any uptime
+static long long tick_ns(const audio_uio_t *uio, uint64_t tick) {
+    return uio->start_ns + (long long)(tick / uio->sample_rate) * 1000000000LL +
+           (long long)(tick % uio->sample_rate) * 1000000000LL / uio->sample_rate;
+}
+
+// Tick whose period contains time t
+static uint64_t tick_at(const audio_uio_t *uio, long long t) {
+    long long elapsed = t - uio->start_ns;
+    return (uint64_t)(elapsed / 1000000000LL) * uio->sample_rate +
+           (uint64_t)(elapsed % 1000000000LL) * uio->sample_rate / 1000000000LL;
+}
+
+// Function to map the pages holding the register window, which starts offset bytes into them
+static audio_uio_t *uio_map(int fd, size_t map_size, size_t offset, int sample_rate) {
+    audio_uio_t *uio = calloc(1, sizeof(*uio));
+    if (!uio) {
+        close(fd);
+        return NULL;
+    }
+    uio->fd = fd;
+    uio->map_size = map_size;
+    uio->sample_rate = sample_rate;
+    uio->start_ns = now_ns();
+    if (offset % sizeof(uint32_t) != 0 || offset + (AUDIO_UIO_DATA_REG + 1) * sizeof(uint32_t) > map_size) {
+        printf("Error: Audio registers at offset %zu do not fit the %zu-byte map.\n", offset, map_size);
+        close(fd);
+        free(uio);
+        return NULL;
+    }
+    // Map 0 is at file offset 0; the registers are only read
+    void *map = mmap(NULL, map_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        printf("Error: Unable to map the audio registers.\n");
+        close(fd);
+        free(uio);
+        return NULL;
+    }
+    uio->map = map;
+    uio->regs = (volatile uint32_t *)((unsigned char *)map + offset);
+    return uio;
+}
+
+// Function to read one line of a sysfs attribute
+static bool read_attribute(const char *path, char *value, size_t size) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+    bool ok = fgets(value, (int)size, file) != NULL;
+    fclose(file);
+    value[strcspn(value, "\n")] = '\0';
+    return ok;
+}
+
+// Function to locate and map the driver's UIO device
+audio_uio_t *audio_uio_open(int sample_rate) {
+    if (sample_rate < 1) {
+        return NULL;
+    }
+    for (int i = 0; i < UIO_MAX_DEVICES; i++) {
+        char path[64], value[64];
+        snprintf(path, sizeof(path), "/sys/class/uio/uio%d/name", i);
+        if (!read_attribute(path, value, sizeof(value)) || strcmp(value, AUDIO_UIO_NAME) != 0) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "/sys/class/uio/uio%d/maps/map0/size", i);
+        if (!read_attribute(path, value, sizeof(value))) {
+            break;
+        }
+        size_t map_size = strtoul(value, NULL, 0);
+        // A register window that is not page-aligned starts this far into the mapping
+        size_t offset = 0;
+        snprintf(path, sizeof(path), "/sys/class/uio/uio%d/maps/map0/offset", i);
+        if (read_attribute(path, value, sizeof(value))) {
+            offset = strtoul(value, NULL, 0);
+        }
+        snprintf(path, sizeof(path), "/dev/uio%d", i);
+        int fd = open(path, O_RDWR);
+        if (fd < 0) {
+            perror("could not open UIO device");
+            return NULL;
+        }
+        return uio_map(fd, map_size, offset, sample_rate);
+    }
+    printf("Error: No %s UIO device (load the driver with uio=1).\n", AUDIO_UIO_NAME);
+    return NULL;
+}
+
+// Function to map a file standing in for the register window
+audio_uio_t *audio_uio_open_file(const char *path, int sample_rate, int event_samples) {
+    if (sample_rate < 1 || event_samples < 1) {
+        return NULL;
+    }
+    int fd = open(path, O_RDWR);
+    if (fd < 0) {
+        perror("could not open register stand-in");
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < (off_t)((AUDIO_UIO_DATA_REG + 1) * sizeof(uint32_t))) {
+        printf("Error: Register stand-in %s is too small.\n", path);
+        close(fd);
+        return NULL;
+    }
+    audio_uio_t *uio = uio_map(fd, (AUDIO_UIO_DATA_REG + 1) * sizeof(uint32_t), 0, sample_rate);
+    if (uio) {
+        uio->stand_in = true;
+        uio->event_samples = event_samples;
+    }
+    return uio;
+}
+
+// Function to sleep until the device's next event
+int audio_uio_wait(audio_uio_t *uio) {
+    uint32_t count;
+    if (uio->stand_in) {
+        // Emulated events fall every event_samples ticks
+        uint64_t period = uio->event_samples;
+        count = (uint32_t)(tick_at(uio, now_ns()) / period + 1);
+        long long due = tick_ns(uio, count * period);
+        struct timespec until = {due / 1000000000LL, due % 1000000000LL};
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL) != 0) {
+        }
+    } else if (read(uio->fd, &count, sizeof(count)) != sizeof(count)) {
+        perror("UIO read failed");
+        return -1;
+    }
+    int events = uio->events == 0 ? 1 : (int)(count - uio->events);
+    uio->events = count;
+    return events;
+}
+
+// Function to sample the data register at the sample rate without syscalls
+bool audio_uio_read_bulk(audio_uio_t *uio, audio_data_bulk_t *bulk) {
+    if (bulk->count == 0 || bulk->count > AUDIO_BULK_SAMPLES) {
+        bulk->count = AUDIO_BULK_SAMPLES;
+    }
+    long long period_ns = 1000000000LL / uio->sample_rate;
+
+    for (uint32_t i = 0; i < bulk->count; i++) {
+        long long due = tick_ns(uio, uio->tick);
+        long long now;
+        while ((now = now_ns()) < due) {
+        }
+        // A period or more late, the register has moved on: resume at the current tick
+        if (now - due >= period_ns) {
+            uint64_t current = tick_at(uio, now);
+            uio->missed += current - uio->tick;
+            uio->tick = current;
+        }
+        if (i == 0) {
+            bulk->sequence = uio->tick;
+            bulk->timestamp_ns = tick_ns(uio, uio->tick);
+        }
+        bulk->data[i].data = (unsigned char)audio_uio_load(uio);
+        uio->tick++;
+    }
+    bulk->overruns = 0;
+    return true;
+}
+
+void audio_uio_close(audio_uio_t *uio) {
+    if (!uio) return;
+    munmap(uio->map, uio->map_size);
+    close(uio->fd);
+    free(uio);
+}
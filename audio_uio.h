@@ -0,0 +1,56 @@
+#ifndef _AUDIO_UIO_H
+#define _AUDIO_UIO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "audio_ioctl.h"
+
+// Direct register access for the driver's UIO mode (see audio_ioctl.h):
+// samples are taken with plain loads from the mapped data register, paced by
+// CLOCK_MONOTONIC (a vDSO call, no syscall), so capture never enters the
+// kernel. The register holds only the latest sample, so the capture thread
+// spins at the sample rate. The driver's block events arrive through read()
+// on the UIO descriptor.
+//
+// For testing without the FPGA, the register window can be any file (or
+// /dev/shm object) that another thread or process writes samples into; the
+// block events are then emulated from the clock.
+typedef struct {
+    int fd;                     // /dev/uioN, or the stand-in file
+    volatile uint32_t *regs;    // map 0: the register window
+    void *map;                  // the mapped pages, regs less the window's offset into them
+    size_t map_size;
+    bool stand_in;
+    int sample_rate;
+    int event_samples;          // stand-in: sample periods between emulated events
+    uint32_t events;            // last event count seen
+    uint64_t tick;              // sample clock tick of the next capture
+    long long start_ns;         // CLOCK_MONOTONIC time of tick 0
+    uint64_t missed;            // ticks skipped because the capture ran late (not a ring overrun)
+} audio_uio_t;
+
+// Find the driver's UIO device by name and map its registers; NULL on failure
+audio_uio_t *audio_uio_open(int sample_rate);
+
+// Use the first word of a file as the data register; NULL on failure
+audio_uio_t *audio_uio_open_file(const char *path, int sample_rate, int event_samples);
+
+// Latest sample: one load from the device
+static inline uint32_t audio_uio_load(const audio_uio_t *uio) {
+    return uio->regs[AUDIO_UIO_DATA_REG];
+}
+
+// Block until the next event; returns the number of events since the
+// previous wait (more than 1: events were missed), -1 on error
+int audio_uio_wait(audio_uio_t *uio);
+
+// Take bulk->count samples (0: AUDIO_BULK_SAMPLES) at the sample rate and
+// fill in the tick and time of the first, like AUDIO_DATA_READ_BULK. There is
+// no ring, so bulk->overruns is 0; ticks skipped because the capture ran late
+// show as a jump in bulk->sequence and add up in uio->missed.
+bool audio_uio_read_bulk(audio_uio_t *uio, audio_data_bulk_t *bulk);
+
+void audio_uio_close(audio_uio_t *uio);
+
+#endif
@@ -0,0 +1,111 @@
+#include <stdlib.h>
+#include <time.h>
+
+#include "capture_ring.h"
+
+// Function to create a capture ring with every block free
+capture_ring_t *capture_ring_create(int num_blocks, size_t block_size) {
+    if (num_blocks < 1 || block_size == 0) {
+        return NULL;
+    }
+
+    capture_ring_t *ring = calloc(1, sizeof(*ring));
+    if (!ring) {
+        return NULL;
+    }
+    ring->block_size = block_size;
+    ring->num_blocks = num_blocks;
+    ring->storage = malloc((size_t)num_blocks * block_size);
+    ring->spare = malloc(block_size);
+    ring->free_blocks = spsc_create(num_blocks);
+    ring->filled_blocks = spsc_create(num_blocks);
+    if (!ring->storage || !ring->spare || !ring->free_blocks || !ring->filled_blocks) {
+        capture_ring_destroy(ring);
+        return NULL;
+    }
+    for (int b = 0; b < num_blocks; b++) {
+        spsc_push(ring->free_blocks, ring->storage + (size_t)b * block_size);
+    }
+    atomic_init(&ring->overruns, 0);
+    atomic_init(&ring->underruns, 0);
+    atomic_init(&ring->captured, 0);
+    atomic_init(&ring->max_fill, 0);
+    return ring;
+}
+
+void capture_ring_set_deadline(capture_ring_t *ring, long long deadline_ns) {
+    ring->deadline_ns = deadline_ns;
+}
+
+// Function to read CLOCK_MONOTONIC in nanoseconds
+static long long monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+void *capture_ring_write_begin(capture_ring_t *ring) {
+    ring->writing = spsc_pop(ring->free_blocks);
+    return ring->writing ? ring->writing : ring->spare;
+}
+
+void capture_ring_write_commit(capture_ring_t *ring) {
+    if (!ring->writing) {
+        atomic_fetch_add_explicit(&ring->overruns, 1, memory_order_relaxed);
+        return;
+    }
+    spsc_push(ring->filled_blocks, ring->writing); // never full: at most num_blocks handles exist
+    ring->writing = NULL;
+    atomic_fetch_add_explicit(&ring->captured, 1, memory_order_relaxed);
+
+    int fill = (int)spsc_count(ring->filled_blocks);
+    int max_fill = atomic_load_explicit(&ring->max_fill, memory_order_relaxed);
+    if (fill > max_fill) {
+        atomic_store_explicit(&ring->max_fill, fill, memory_order_relaxed); // only capture writes it
+    }
+}
+
+void *capture_ring_read_begin(capture_ring_t *ring) {
+    ring->reading = spsc_pop(ring->filled_blocks);
+    return ring->reading;
+}
+
+void *capture_ring_read_wait(capture_ring_t *ring) {
+    if (capture_ring_read_begin(ring)) {
+        return ring->reading;
+    }
+
+    // An empty ring is the normal state when analysis keeps up; only a block
+    // later than the deadline means capture fell behind real time
+    long long start = monotonic_ns();
+    ring->reading = spsc_pop_wait(ring->filled_blocks);
+    if (ring->deadline_ns > 0 && monotonic_ns() - start > ring->deadline_ns) {
+        atomic_fetch_add_explicit(&ring->underruns, 1, memory_order_relaxed);
+    }
+    return ring->reading;
+}
+
+void capture_ring_read_release(capture_ring_t *ring) {
+    if (ring->reading) {
+        spsc_push(ring->free_blocks, ring->reading);
+        ring->reading = NULL;
+    }
+}
+
+void capture_ring_stats(capture_ring_t *ring, capture_ring_stats_t *stats) {
+    stats->overruns = atomic_load_explicit(&ring->overruns, memory_order_relaxed);
+    stats->underruns = atomic_load_explicit(&ring->underruns, memory_order_relaxed);
+    stats->captured = atomic_load_explicit(&ring->captured, memory_order_relaxed);
+    stats->fill = (int)spsc_count(ring->filled_blocks);
+    stats->max_fill = atomic_load_explicit(&ring->max_fill, memory_order_relaxed);
+    stats->capacity = ring->num_blocks;
+}
+
+void capture_ring_destroy(capture_ring_t *ring) {
+    if (!ring) return;
+    free(ring->storage);
+    free(ring->spare);
+    spsc_destroy(ring->free_blocks);
+    spsc_destroy(ring->filled_blocks);
+    free(ring);
+}
@@ -0,0 +1,69 @@
+#ifndef _CAPTURE_RING_H
+#define _CAPTURE_RING_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "spsc_queue.h"
+
+// Lock-free ring of fixed-size sample blocks between one capture thread and
+// one analysis thread. Blocks circulate by handle through a free queue and a
+// filled queue, so neither side ever copies or stalls the other. When the
+// analysis falls behind, capture keeps draining the device into a spare block
+// that is then discarded (an overrun) instead of stalling the device. An
+// analysis thread with nothing to do sleeps in capture_ring_read_wait() until
+// capture commits a block.
+typedef struct {
+    size_t block_size;    // bytes per block
+    int num_blocks;
+    unsigned char *storage;
+    unsigned char *spare; // capture target while the ring is full
+    spsc_queue_t *free_blocks;   // analysis -> capture
+    spsc_queue_t *filled_blocks; // capture -> analysis
+    void *writing;        // capture side: block being filled
+    void *reading;        // analysis side: block being consumed
+    atomic_ulong overruns;    // blocks captured while the ring was full, lost
+    atomic_ulong underruns;   // waits for a block that outlasted the deadline
+    atomic_ulong captured;    // blocks committed into the ring
+    atomic_int max_fill;      // high-water mark of filled blocks
+    long long deadline_ns;    // longest normal wait for a block (0: never an underrun)
+} capture_ring_t;
+
+typedef struct {
+    unsigned long overruns;
+    unsigned long underruns;
+    unsigned long captured;
+    int fill;     // filled blocks waiting for analysis
+    int max_fill;
+    int capacity;
+} capture_ring_stats_t;
+
+// Create a ring of num_blocks blocks of block_size bytes; NULL on failure
+capture_ring_t *capture_ring_create(int num_blocks, size_t block_size);
+
+// Longest a wait for the next block may take while capture keeps up,
+// normally one block period; any longer wait counts as an underrun
+void capture_ring_set_deadline(capture_ring_t *ring, long long deadline_ns);
+
+// Capture thread: block to fill next (never NULL; the spare block when full)
+void *capture_ring_write_begin(capture_ring_t *ring);
+
+// Capture thread: publish the block from capture_ring_write_begin()
+void capture_ring_write_commit(capture_ring_t *ring);
+
+// Analysis thread: oldest filled block, or NULL
+void *capture_ring_read_begin(capture_ring_t *ring);
+
+// Analysis thread: oldest filled block, sleeping until capture commits one;
+// a sleep past the deadline counts as an underrun
+void *capture_ring_read_wait(capture_ring_t *ring);
+
+// Analysis thread: hand the block from capture_ring_read_begin() back to capture
+void capture_ring_read_release(capture_ring_t *ring);
+
+// Any thread: snapshot of the counters and the current fill level
+void capture_ring_stats(capture_ring_t *ring, capture_ring_stats_t *stats);
+
+void capture_ring_destroy(capture_ring_t *ring);
+
+#endif
@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <complex.h>
+#include <math.h>
+
+#include "cqt.h"
+
+// Function to build the sparse spectral kernel of one bin into the CSR arrays
+static int cqt_build_row(cqt_t *cqt, fft_plan_t *plan, fft_complex_t *temporal,
+                         int sample_rate, double frequency, int nnz, int *capacity) {
+    int n = cqt->fft_size;
+    int len = (int)ceil(cqt->q * sample_rate / frequency);
+    if (len > n) {
+        len = n;
+    }
+
+    // Hann-windowed exponential of len samples, centred in the frame, unit-gain
+    int start = (n - len) / 2;
+    for (int i = 0; i < n; i++) {
+        temporal[i] = 0;
+    }
+    for (int i = 0; i < len; i++) {
+        double w = 0.5 - 0.5 * cos(2 * M_PI * (i + 0.5) / len);
+        temporal[start + i] = w / len * cexp(I * 2 * M_PI * frequency * (start + i) / sample_rate);
+    }
+    fft_plan_execute(plan, temporal);
+
+    // By Parseval, sum x[i] conj(t[i]) = sum X[j] conj(T[j]) / n; the kernel of a
+    // positive frequency is negligible outside bins 0 .. n / 2
+    double peak = 0.0;
+    for (int j = 0; j <= n / 2; j++) {
+        double m = cabs(temporal[j]);
+        if (m > peak) {
+            peak = m;
+        }
+    }
+    for (int j = 0; j <= n / 2; j++) {
+        if (cabs(temporal[j]) < CQT_KERNEL_THRESHOLD * peak) {
+            continue;
+        }
+        if (nnz == *capacity) {
+            int grown = *capacity * 2;
+            int *cols = realloc(cqt->cols, grown * sizeof(int));
+            if (cols) {
+                cqt->cols = cols;
+            }
+            fft_complex_t *kernel = realloc(cqt->kernel, grown * sizeof(fft_complex_t));
+            if (kernel) {
+                cqt->kernel = kernel;
+            }
+            if (!cols || !kernel) {
+                return -1;
+            }
+            *capacity = grown;
+        }
+        cqt->cols[nnz] = j;
+        cqt->kernel[nnz] = conj(temporal[j]) / n;
+        nnz++;
+    }
+    return nnz;
+}
+
+// Function to create a constant-Q transform aligned with the note table
+cqt_t *cqt_create(int fft_size, int sample_rate, int bins_per_octave, int first_note, int num_notes) {
+    if ((bins_per_octave != 12 && bins_per_octave != 36) || first_note < 0 || num_notes < 1 ||
+        first_note + num_notes > NUM_PIANO_NOTES || sample_rate < 1) {
+        printf("Error: Invalid CQT parameters.\n");
+        return NULL;
+    }
+
+    cqt_t *cqt = calloc(1, sizeof(*cqt));
+    if (!cqt) {
+        return NULL;
+    }
+    int per_note = bins_per_octave / 12;
+    int capacity = 1024;
+    cqt->fft_size = fft_size;
+    cqt->bins_per_octave = bins_per_octave;
+    cqt->num_bins = num_notes * per_note;
+    cqt->q = 1.0 / (pow(2.0, 1.0 / bins_per_octave) - 1.0);
+    cqt->frequencies = malloc(cqt->num_bins * sizeof(double));
+    cqt->row_start = malloc((cqt->num_bins + 1) * sizeof(int));
+    cqt->cols = malloc(capacity * sizeof(int));
+    cqt->kernel = malloc(capacity * sizeof(fft_complex_t));
+    cqt->plan = fft_plan_create_real(fft_size, FFT_PRECISION_DOUBLE);
+    cqt->spectrum = malloc((fft_size / 2 + 1) * sizeof(fft_complex_t));
+    fft_plan_t *kernel_plan = fft_plan_create(fft_size, FFT_FORWARD, FFT_PRECISION_DOUBLE);
+    fft_complex_t *temporal = malloc(fft_size * sizeof(fft_complex_t));
+    if (!cqt->frequencies || !cqt->row_start || !cqt->cols || !cqt->kernel || !cqt->plan ||
+        !cqt->spectrum || !kernel_plan || !temporal) {
+        fft_plan_destroy(kernel_plan);
+        free(temporal);
+        cqt_destroy(cqt);
+        return NULL;
+    }
+
+    // Centre bins sit exactly on note_frequencies[]; 36-bin mode adds +-1/3 semitone
+    int nnz = 0;
+    for (int b = 0; b < cqt->num_bins; b++) {
+        double frequency = note_frequencies[first_note + b / per_note];
+        if (per_note == 3) {
+            frequency *= pow(2.0, (b % 3 - 1) / 36.0);
+        }
+        cqt->frequencies[b] = frequency;
+        cqt->row_start[b] = nnz;
+        nnz = cqt_build_row(cqt, kernel_plan, temporal, sample_rate, frequency, nnz, &capacity);
+        if (nnz < 0) {
+            fft_plan_destroy(kernel_plan);
+            free(temporal);
+            cqt_destroy(cqt);
+            return NULL;
+        }
+    }
+    cqt->row_start[cqt->num_bins] = nnz;
+
+    fft_plan_destroy(kernel_plan);
+    free(temporal);
+    return cqt;
+}
+
+// Function to apply the sparse kernel to one real FFT
+void cqt_apply(const cqt_t *cqt, const fft_complex_t *spectrum, fft_complex_t *out) {
+    for (int b = 0; b < cqt->num_bins; b++) {
+        fft_complex_t sum = 0;
+        for (int e = cqt->row_start[b]; e < cqt->row_start[b + 1]; e++) {
+            sum += spectrum[cqt->cols[e]] * cqt->kernel[e];
+        }
+        out[b] = sum;
+    }
+}
+
+// Function to transform one frame of samples
+void cqt_process(cqt_t *cqt, const double *frame, fft_complex_t *out) {
+    fft_plan_execute_real(cqt->plan, frame, cqt->spectrum);
+    cqt_apply(cqt, cqt->spectrum, out);
+}
+
+void cqt_destroy(cqt_t *cqt) {
+    if (!cqt) return;
+    free(cqt->frequencies);
+    free(cqt->row_start);
+    free(cqt->cols);
+    free(cqt->kernel);
+    fft_plan_destroy(cqt->plan);
+    free(cqt->spectrum);
+    free(cqt);
+}
@@ -0,0 +1,40 @@
+#ifndef _CQT_H
+#define _CQT_H
+
+#include "fft_engine.h"
+#include "notes.h"
+
+// Spectral-kernel entries below this fraction of their row's peak are dropped
+#define CQT_KERNEL_THRESHOLD 0.005
+
+// Constant-Q transform computed as a sparse matrix product on the bins of one
+// real FFT (Brown & Puckette). Bin k analyses a Hann-windowed complex
+// exponential at frequencies[k], window length Q * fs / f_k centred in the
+// frame; windows longer than the frame are clamped to it, which widens the
+// lowest bins when fft_size is too short for their Q.
+typedef struct {
+    int fft_size;
+    int bins_per_octave; // 12: one bin per note; 36: note and +-1/3 semitone
+    int num_bins;
+    double q;
+    double *frequencies;    // centre frequency of each bin, ascending
+    int *row_start;         // num_bins + 1 offsets into cols / kernel
+    int *cols;              // FFT bin index of each kernel entry (0 .. fft_size / 2)
+    fft_complex_t *kernel;  // sparse spectral kernel, already conjugated and scaled by 1 / fft_size
+    fft_plan_t *plan;       // real plan of fft_size, for cqt_process()
+    fft_complex_t *spectrum; // fft_size / 2 + 1 scratch bins
+} cqt_t;
+
+// Create a CQT over notes first_note .. first_note + num_notes - 1 of
+// note_frequencies[] with 12 or 36 bins per octave; NULL on failure
+cqt_t *cqt_create(int fft_size, int sample_rate, int bins_per_octave, int first_note, int num_notes);
+
+// Apply the kernel to the fft_size / 2 + 1 bins of a real FFT of one frame
+void cqt_apply(const cqt_t *cqt, const fft_complex_t *spectrum, fft_complex_t *out);
+
+// Transform fft_size unwindowed samples into cqt->num_bins coefficients
+void cqt_process(cqt_t *cqt, const double *frame, fft_complex_t *out);
+
+void cqt_destroy(cqt_t *cqt);
+
+#endif
@@ -0,0 +1,796 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <complex.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "cqt.h"
+#include "fft_engine.h"
+#include "goertzel.h"
+#include "simd.h"
+
+// Forward-transform microbenchmark: every precision, layout and kernel of the
+// engine for N = 64 .. 65536, against a naive O(N^2) DFT. Results go to stdout
+// as CSV (default) or JSON, one record per transform variant and size:
+//   ns_per_transform  best of BENCH_RUNS timed batches, input copy subtracted
+//   ns_per_point      ns_per_transform / N
+//   gflops            nominal 5 N log2 N flops per complex transform (2.5 N log2 N
+//                     for real input), the usual convention, also for the DFT
+//   speedup_vs_dft    DFT time / this time, for N up to --dft-max
+//   rel_error         ||X - X_ref|| / ||X_ref|| with X_ref the double DFT, or the
+//                     double radix-2 transform above --dft-max
+//
+// With --notes it measures the note analyzers instead: energy at the 88 piano
+// note frequencies from one frame of N samples at NOTES_SAMPLE_RATE, for a
+// signal of note tones plus noise:
+//   ns_per_frame      best of BENCH_RUNS timed batches
+//   speedup_vs_fft    fft_bins time / this time
+//   rel_error         ||E - E_ref|| / ||E_ref|| over the analyzed notes, with E_ref the
+//                     energy of a direct DTFT at each note frequency; for the
+//                     constant-Q analyzers the complex coefficients against a
+//                     direct time-domain CQT with the same windowed kernels
+//
+// Usage: fft_bench [--csv | --json] [--notes] [--min N] [--max N] [--time seconds] [--dft-max N]
+
+#define BENCH_MIN_N 64
+#define BENCH_MAX_N 65536
+#define BENCH_MIN_TIME 0.05  // Seconds per timed batch; batches double in size until they last this long
+#define BENCH_RUNS 5         // Timed batches per measurement; the fastest is reported
+#define BENCH_DFT_MAX_N 8192 // Largest N for the O(N^2) baseline
+#define BENCH_SEED 0x2545F4914F6CDD1DULL
+#define NOTES_SAMPLE_RATE 48000
+#define NOTES_TONE_STEP 7    // --notes signal: a tone on every 7th note, plus noise
+
+// One transform under test
+typedef enum {
+    VARIANT_COMPLEX,       // fft_plan_execute(): interleaved complex double
+    VARIANT_COMPLEX_SPLIT, // fft_plan_execute_split(): separate re/im arrays
+    VARIANT_REAL,          // fft_plan_execute_real_packed(): n real samples
+    VARIANT_COMPLEX_FLOAT, // fft_plan_execute_float()
+    VARIANT_REAL_FLOAT,    // fft_plan_execute_real_float_packed()
+    VARIANT_COMPLEX_Q15,   // fft_plan_execute_q15()
+    VARIANT_DFT            // naive DFT baseline
+} variant_type_t;
+
+typedef struct {
+    variant_type_t type;
+    const char *transform; // "complex" / "real"
+    const char *precision;
+    const char *kernel;
+    fft_kernel_t fft_kernel;
+} variant_t;
+
+static const variant_t variants[] = {
+    {VARIANT_DFT, "complex", "double", "dft", FFT_KERNEL_RADIX2},
+    {VARIANT_COMPLEX, "complex", "double", "radix2", FFT_KERNEL_RADIX2},
+    {VARIANT_COMPLEX, "complex", "double", "radix4", FFT_KERNEL_RADIX4},
+    {VARIANT_COMPLEX, "complex", "double", "split_radix", FFT_KERNEL_SPLIT_RADIX},
+    {VARIANT_COMPLEX, "complex", "double", "simd_split", FFT_KERNEL_SIMD_SPLIT},
+    {VARIANT_COMPLEX_SPLIT, "complex_soa", "double", "simd_split", FFT_KERNEL_SIMD_SPLIT},
+    {VARIANT_REAL, "real", "double", "radix2", FFT_KERNEL_RADIX2},
+    {VARIANT_REAL, "real", "double", "radix4", FFT_KERNEL_RADIX4},
+    {VARIANT_REAL, "real", "double", "split_radix", FFT_KERNEL_SPLIT_RADIX},
+    {VARIANT_REAL, "real", "double", "simd_split", FFT_KERNEL_SIMD_SPLIT},
+    {VARIANT_COMPLEX_FLOAT, "complex", "float", "radix4", FFT_KERNEL_RADIX4},
+    {VARIANT_REAL_FLOAT, "real", "float", "radix4", FFT_KERNEL_RADIX4},
+    {VARIANT_COMPLEX_Q15, "complex", "q15", "radix2", FFT_KERNEL_RADIX2},
+};
+#define NUM_VARIANTS (int)(sizeof(variants) / sizeof(variants[0]))
+
+// Buffers for one size: the input, a work copy per layout, and the reference spectrum
+typedef struct {
+    int n;
+    double *input;              // n real samples in [-0.5, 0.5)
+    fft_complex_t *reference;   // n bins
+    fft_complex_t *dft_twiddles;
+    fft_complex_t *work;        // n (real plans: n / 2 + 1 bins)
+    double *work_re, *work_im;  // n each
+    fft_complex_float_t *work_f;
+    fft_q15_t *work_q15;
+    fft_complex_t *packed;      // input packed as pairs, for real plans
+    fft_complex_float_t *packed_f;
+    fft_complex_t *input_c;     // input as complex, the source of each copy
+    fft_complex_float_t *input_cf;
+    fft_q15_t *input_q15;
+    fft_plan_t *plan;           // the variant being measured
+    const variant_t *variant;
+    int q15_exponent;
+} bench_t;
+
+typedef struct {
+    const variant_t *variant;
+    int n;
+    long reps;
+    double ns;
+    double rel_error;
+    double dft_ns; // 0 when the DFT was not run at this size
+} result_t;
+
+static double now_seconds(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// Naive DFT with an n-entry twiddle table: exact index arithmetic, no libm
+static void dft(const fft_complex_t *twiddles, const fft_complex_t in[], fft_complex_t out[], int n) {
+    for (int k = 0; k < n; k++) {
+        fft_complex_t sum = 0.0;
+        unsigned int index = 0;
+        for (int j = 0; j < n; j++) {
+            sum += in[j] * twiddles[index];
+            index = (index + k) & (n - 1);
+        }
+        out[k] = sum;
+    }
+}
+
+// Function to copy the input into the variant's work buffer
+static void prepare(bench_t *b) {
+    int n = b->n;
+    switch (b->variant->type) {
+    case VARIANT_COMPLEX:
+    case VARIANT_DFT:
+        memcpy(b->work, b->input_c, n * sizeof(fft_complex_t));
+        break;
+    case VARIANT_COMPLEX_SPLIT:
+        memcpy(b->work_re, b->input, n * sizeof(double));
+        memset(b->work_im, 0, n * sizeof(double));
+        break;
+    case VARIANT_REAL:
+        memcpy(b->work, b->packed, n / 2 * sizeof(fft_complex_t));
+        break;
+    case VARIANT_COMPLEX_FLOAT:
+        memcpy(b->work_f, b->input_cf, n * sizeof(fft_complex_float_t));
+        break;
+    case VARIANT_REAL_FLOAT:
+        memcpy(b->work_f, b->packed_f, n / 2 * sizeof(fft_complex_float_t));
+        break;
+    case VARIANT_COMPLEX_Q15:
+        memcpy(b->work_q15, b->input_q15, n * sizeof(fft_q15_t));
+        break;
+    }
+}
+
+// Function to run the variant's transform on its prepared work buffer
+static void execute(bench_t *b) {
+    switch (b->variant->type) {
+    case VARIANT_COMPLEX:
+        fft_plan_execute(b->plan, b->work);
+        break;
+    case VARIANT_COMPLEX_SPLIT:
+        fft_plan_execute_split(b->plan, b->work_re, b->work_im);
+        break;
+    case VARIANT_REAL:
+        fft_plan_execute_real_packed(b->plan, b->work);
+        break;
+    case VARIANT_COMPLEX_FLOAT:
+        fft_plan_execute_float(b->plan, b->work_f);
+        break;
+    case VARIANT_REAL_FLOAT:
+        fft_plan_execute_real_float_packed(b->plan, b->work_f);
+        break;
+    case VARIANT_COMPLEX_Q15:
+        b->q15_exponent = fft_plan_execute_q15(b->plan, b->work_q15);
+        break;
+    case VARIANT_DFT:
+        dft(b->dft_twiddles, b->input_c, b->work, b->n);
+        break;
+    }
+}
+
+// Seconds for reps iterations, with or without the transform
+static double time_batch(bench_t *b, long reps, bool transform) {
+    double start = now_seconds();
+    for (long r = 0; r < reps; r++) {
+        prepare(b);
+        if (transform) {
+            execute(b);
+        }
+    }
+    return now_seconds() - start;
+}
+
+// Function to measure ns per transform: grow the batch to min_time, keep the best run
+static double measure(bench_t *b, double min_time, long *reps_out) {
+    long reps = 1;
+    prepare(b);
+    execute(b); // warm caches and pages
+    while (time_batch(b, reps, true) < min_time && reps < (1L << 40)) {
+        reps *= 2;
+    }
+
+    double best = INFINITY, best_copy = INFINITY;
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        double t = time_batch(b, reps, true);
+        double c = time_batch(b, reps, false);
+        if (t < best) best = t;
+        if (c < best_copy) best_copy = c;
+    }
+    *reps_out = reps;
+    double ns = (best - best_copy) / reps * 1e9;
+    return ns > 0.0 ? ns : best / reps * 1e9;
+}
+
+// Function to compare the work buffer against the reference spectrum
+static double relative_error(const bench_t *b) {
+    int n = b->n;
+    int bins = (b->variant->type == VARIANT_REAL || b->variant->type == VARIANT_REAL_FLOAT) ? n / 2 + 1 : n;
+    double scale = ldexp(1.0, b->q15_exponent) / 32768.0;
+    double err = 0.0, ref = 0.0;
+
+    for (int k = 0; k < bins; k++) {
+        fft_complex_t x;
+        switch (b->variant->type) {
+        case VARIANT_COMPLEX_SPLIT:
+            x = CMPLX(b->work_re[k], b->work_im[k]);
+            break;
+        case VARIANT_COMPLEX_FLOAT:
+        case VARIANT_REAL_FLOAT:
+            x = b->work_f[k];
+            break;
+        case VARIANT_COMPLEX_Q15:
+            x = CMPLX(b->work_q15[k].re * scale, b->work_q15[k].im * scale);
+            break;
+        default:
+            x = b->work[k];
+            break;
+        }
+        err += cabs(x - b->reference[k]) * cabs(x - b->reference[k]);
+        ref += cabs(b->reference[k]) * cabs(b->reference[k]);
+    }
+    return ref > 0.0 ? sqrt(err / ref) : 0.0;
+}
+
+static void bench_free(bench_t *b) {
+    free(b->input);
+    free(b->reference);
+    free(b->dft_twiddles);
+    free(b->work);
+    free(b->work_re);
+    free(b->work_im);
+    free(b->work_f);
+    free(b->work_q15);
+    free(b->packed);
+    free(b->packed_f);
+    free(b->input_c);
+    free(b->input_cf);
+    free(b->input_q15);
+}
+
+// Function to allocate the buffers for size n and fill the input and reference
+static bool bench_init(bench_t *b, int n, bool run_dft) {
+    memset(b, 0, sizeof(*b));
+    b->n = n;
+    b->input = malloc(n * sizeof(double));
+    b->reference = malloc(n * sizeof(fft_complex_t));
+    b->dft_twiddles = malloc(n * sizeof(fft_complex_t));
+    b->work = malloc(n * sizeof(fft_complex_t));
+    b->work_re = malloc(n * sizeof(double));
+    b->work_im = malloc(n * sizeof(double));
+    b->work_f = malloc(n * sizeof(fft_complex_float_t));
+    b->work_q15 = malloc(n * sizeof(fft_q15_t));
+    b->packed = malloc(n / 2 * sizeof(fft_complex_t));
+    b->packed_f = malloc(n / 2 * sizeof(fft_complex_float_t));
+    b->input_c = malloc(n * sizeof(fft_complex_t));
+    b->input_cf = malloc(n * sizeof(fft_complex_float_t));
+    b->input_q15 = malloc(n * sizeof(fft_q15_t));
+    if (!b->input || !b->reference || !b->dft_twiddles || !b->work || !b->work_re || !b->work_im ||
+        !b->work_f || !b->work_q15 || !b->packed || !b->packed_f || !b->input_c || !b->input_cf ||
+        !b->input_q15) {
+        printf("Error: Out of memory.\n");
+        bench_free(b);
+        return false;
+    }
+
+    // Uniform noise quantized to Q15, so every precision sees the same signal
+    uint64_t rng = BENCH_SEED ^ (uint64_t)n;
+    for (int i = 0; i < n; i++) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        int16_t q = (int16_t)((int)(rng >> 48) - 32768) / 2;
+        b->input[i] = q / 32768.0;
+        b->input_c[i] = b->input[i];
+        b->input_cf[i] = (float)b->input[i];
+        b->input_q15[i].re = q;
+        b->input_q15[i].im = 0;
+    }
+    for (int k = 0; k < n / 2; k++) {
+        b->packed[k] = CMPLX(b->input[2 * k], b->input[2 * k + 1]);
+        b->packed_f[k] = b->packed[k];
+    }
+    for (int k = 0; k < n; k++) {
+        b->dft_twiddles[k] = cexp(-2.0 * I * M_PI * k / n);
+    }
+
+    if (run_dft) {
+        dft(b->dft_twiddles, b->input_c, b->reference, n);
+    } else {
+        fft_plan_t *plan = fft_plan_create(n, FFT_FORWARD, FFT_PRECISION_DOUBLE);
+        if (!plan) {
+            printf("Error: Unable to create FFT plan.\n");
+            bench_free(b);
+            return false;
+        }
+        fft_plan_set_kernel(plan, FFT_KERNEL_RADIX2);
+        memcpy(b->reference, b->input_c, n * sizeof(fft_complex_t));
+        fft_plan_execute(plan, b->reference);
+        fft_plan_destroy(plan);
+    }
+    return true;
+}
+
+// Function to create the plan a variant runs on; NULL on failure
+static fft_plan_t *variant_plan(const variant_t *v, int n) {
+    fft_plan_t *plan = NULL;
+    switch (v->type) {
+    case VARIANT_COMPLEX:
+    case VARIANT_COMPLEX_SPLIT:
+        plan = fft_plan_create(n, FFT_FORWARD, FFT_PRECISION_DOUBLE);
+        break;
+    case VARIANT_REAL:
+        plan = fft_plan_create_real(n, FFT_PRECISION_DOUBLE);
+        break;
+    case VARIANT_COMPLEX_FLOAT:
+        plan = fft_plan_create(n, FFT_FORWARD, FFT_PRECISION_FLOAT);
+        break;
+    case VARIANT_REAL_FLOAT:
+        plan = fft_plan_create_real(n, FFT_PRECISION_FLOAT);
+        break;
+    case VARIANT_COMPLEX_Q15:
+        plan = fft_plan_create(n, FFT_FORWARD, FFT_PRECISION_Q15);
+        break;
+    case VARIANT_DFT:
+        return NULL;
+    }
+    if (plan) {
+        fft_plan_set_kernel(plan, v->fft_kernel);
+    }
+    return plan;
+}
+
+static double gflops(const result_t *r) {
+    bool real = strcmp(r->variant->transform, "real") == 0;
+    double flops = (real ? 2.5 : 5.0) * r->n * log2(r->n);
+    return flops / r->ns;
+}
+
+static void print_csv(const result_t *results, int count) {
+    printf("transform,precision,kernel,n,reps,ns_per_transform,ns_per_point,gflops,speedup_vs_dft,rel_error\n");
+    for (int i = 0; i < count; i++) {
+        const result_t *r = &results[i];
+        printf("%s,%s,%s,%d,%ld,%.1f,%.3f,%.3f,", r->variant->transform, r->variant->precision, r->variant->kernel,
+               r->n, r->reps, r->ns, r->ns / r->n, gflops(r));
+        if (r->dft_ns > 0.0) {
+            printf("%.2f", r->dft_ns / r->ns);
+        }
+        printf(",%.3e\n", r->rel_error);
+    }
+}
+
+static void print_json(const result_t *results, int count, double min_time) {
+    printf("{\n  \"simd_width\": %d,\n  \"min_time_s\": %g,\n  \"runs\": %d,\n  \"results\": [\n",
+           SIMD_WIDTH, min_time, BENCH_RUNS);
+    for (int i = 0; i < count; i++) {
+        const result_t *r = &results[i];
+        printf("    {\"transform\": \"%s\", \"precision\": \"%s\", \"kernel\": \"%s\", \"n\": %d, \"reps\": %ld, "
+               "\"ns_per_transform\": %.1f, \"ns_per_point\": %.3f, \"gflops\": %.3f, ",
+               r->variant->transform, r->variant->precision, r->variant->kernel, r->n, r->reps, r->ns, r->ns / r->n,
+               gflops(r));
+        if (r->dft_ns > 0.0) {
+            printf("\"speedup_vs_dft\": %.2f, ", r->dft_ns / r->ns);
+        } else {
+            printf("\"speedup_vs_dft\": null, ");
+        }
+        printf("\"rel_error\": %.3e}%s\n", r->rel_error, i + 1 < count ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+// One note analyzer under test (--notes)
+typedef enum {
+    ANALYZER_FFT_BINS,  // real FFT, energy of the bin nearest each note
+    ANALYZER_GOERTZEL,  // goertzel_bank_process() over all 88 notes, or the sparse set
+    ANALYZER_CQT,       // cqt_process(): real FFT and the sparse spectral kernel, 12 bins per octave
+    ANALYZER_CQT_DIRECT // the same CQT as inner products with the temporal kernels
+} analyzer_type_t;
+
+typedef struct {
+    analyzer_type_t type;
+    const char *name;
+    int harmonics; // goertzel: add the energy at 2f, as the bank's harmonic mode does
+    int sparse;    // goertzel: only the notes carrying tones, every NOTES_TONE_STEP-th
+} analyzer_t;
+
+static const analyzer_t analyzers[] = {
+    {ANALYZER_FFT_BINS, "fft_bins", 0, 0},
+    {ANALYZER_GOERTZEL, "goertzel", 0, 0},
+    {ANALYZER_GOERTZEL, "goertzel_harmonics", 1, 0},
+    {ANALYZER_GOERTZEL, "goertzel_sparse", 0, 1},
+    {ANALYZER_CQT, "cqt_sparse", 0, 0},
+    {ANALYZER_CQT_DIRECT, "cqt_direct", 0, 0},
+};
+#define NUM_ANALYZERS (int)(sizeof(analyzers) / sizeof(analyzers[0]))
+
+// Buffers for one frame size
+typedef struct {
+    int n;
+    double *frame;
+    double reference[NUM_PIANO_NOTES];          // |DTFT|^2 at each note
+    double reference_harmonics[NUM_PIANO_NOTES]; // plus |DTFT|^2 at 2f below Nyquist
+    double energy[NUM_PIANO_NOTES];
+    fft_plan_t *plan;
+    fft_complex_t *spectrum;                    // n / 2 + 1 bins
+    goertzel_bank_t *bank;                      // the analyzer being measured
+    cqt_t *cqt;                                 // built once per size for both CQT analyzers
+    fft_complex_t *temporal;                    // cqt_direct: Hann-windowed exponential per note, back to back
+    int temporal_start[NUM_PIANO_NOTES];        // first frame sample of each note's kernel
+    int temporal_len[NUM_PIANO_NOTES];
+    int temporal_offset[NUM_PIANO_NOTES];       // into temporal[]
+    fft_complex_t cqt_reference[NUM_PIANO_NOTES];
+    fft_complex_t cqt_out[NUM_PIANO_NOTES];
+    const analyzer_t *analyzer;
+} notes_bench_t;
+
+typedef struct {
+    const analyzer_t *analyzer;
+    int n;
+    long reps;
+    double ns;
+    double rel_error;
+    double fft_ns;
+} notes_result_t;
+
+// |sum x[j] exp(-i 2 pi f j / fs)|^2, the quantity a Goertzel filter at f computes
+static double dtft_energy(const double *frame, int n, double frequency) {
+    fft_complex_t sum = 0.0;
+    for (int j = 0; j < n; j++) {
+        sum += frame[j] * cexp(-2.0 * I * M_PI * frequency * j / NOTES_SAMPLE_RATE);
+    }
+    return creal(sum) * creal(sum) + cimag(sum) * cimag(sum);
+}
+
+// Direct CQT: the inner product of the frame with each note's temporal kernel
+static void cqt_direct(const notes_bench_t *b, fft_complex_t out[NUM_PIANO_NOTES]) {
+    for (int i = 0; i < NUM_PIANO_NOTES; i++) {
+        const double *x = b->frame + b->temporal_start[i];
+        const fft_complex_t *t = b->temporal + b->temporal_offset[i];
+        fft_complex_t sum = 0.0;
+        for (int j = 0; j < b->temporal_len[i]; j++) {
+            sum += x[j] * conj(t[j]);
+        }
+        out[i] = sum;
+    }
+}
+
+// Function to run the analyzer on the frame into energy[] (cqt_out[] for the CQT)
+static void notes_execute(notes_bench_t *b) {
+    switch (b->analyzer->type) {
+    case ANALYZER_FFT_BINS:
+        fft_plan_execute_real(b->plan, b->frame, b->spectrum);
+        for (int i = 0; i < NUM_PIANO_NOTES; i++) {
+            int k = (int)lround(note_frequencies[i] * b->n / NOTES_SAMPLE_RATE);
+            fft_complex_t x = b->spectrum[k];
+            b->energy[i] = creal(x) * creal(x) + cimag(x) * cimag(x);
+        }
+        break;
+    case ANALYZER_GOERTZEL:
+        goertzel_bank_process(b->bank, b->frame, b->energy);
+        break;
+    case ANALYZER_CQT:
+        cqt_process(b->cqt, b->frame, b->cqt_out);
+        break;
+    case ANALYZER_CQT_DIRECT:
+        cqt_direct(b, b->cqt_out);
+        break;
+    }
+}
+
+// Function to measure ns per frame: grow the batch to min_time, keep the best run
+static double notes_measure(notes_bench_t *b, double min_time, long *reps_out) {
+    long reps = 1;
+    double t;
+    notes_execute(b); // warm caches and pages
+    for (;;) {
+        double start = now_seconds();
+        for (long r = 0; r < reps; r++) {
+            notes_execute(b);
+        }
+        t = now_seconds() - start;
+        if (t >= min_time || reps >= (1L << 40)) {
+            break;
+        }
+        reps *= 2;
+    }
+
+    double best = t;
+    for (int run = 1; run < BENCH_RUNS; run++) {
+        double start = now_seconds();
+        for (long r = 0; r < reps; r++) {
+            notes_execute(b);
+        }
+        t = now_seconds() - start;
+        if (t < best) best = t;
+    }
+    *reps_out = reps;
+    return best / reps * 1e9;
+}
+
+static double notes_relative_error(const notes_bench_t *b) {
+    if (b->analyzer->type == ANALYZER_CQT || b->analyzer->type == ANALYZER_CQT_DIRECT) {
+        double err = 0.0, ref = 0.0;
+        for (int i = 0; i < NUM_PIANO_NOTES; i++) {
+            err += cabs(b->cqt_out[i] - b->cqt_reference[i]) * cabs(b->cqt_out[i] - b->cqt_reference[i]);
+            ref += cabs(b->cqt_reference[i]) * cabs(b->cqt_reference[i]);
+        }
+        return ref > 0.0 ? sqrt(err / ref) : 0.0;
+    }
+
+    const double *reference = b->analyzer->harmonics ? b->reference_harmonics : b->reference;
+    double err = 0.0, ref = 0.0;
+    for (int i = 0; i < NUM_PIANO_NOTES; i++) {
+        if (b->analyzer->sparse && i % NOTES_TONE_STEP != 0) {
+            continue;
+        }
+        err += (b->energy[i] - reference[i]) * (b->energy[i] - reference[i]);
+        ref += reference[i] * reference[i];
+    }
+    return ref > 0.0 ? sqrt(err / ref) : 0.0;
+}
+
+static void notes_bench_free(notes_bench_t *b) {
+    free(b->frame);
+    free(b->spectrum);
+    fft_plan_destroy(b->plan);
+    cqt_destroy(b->cqt);
+    free(b->temporal);
+}
+
+// Function to lay out the temporal kernels cqt_create() transforms: per note a
+// Hann-windowed exponential of Q fs / f samples (at most n), centred, unit-gain
+static bool notes_bench_init_cqt(notes_bench_t *b) {
+    int n = b->n, total = 0;
+    for (int i = 0; i < NUM_PIANO_NOTES; i++) {
+        int len = (int)ceil(b->cqt->q * NOTES_SAMPLE_RATE / b->cqt->frequencies[i]);
+        b->temporal_len[i] = len > n ? n : len;
+        b->temporal_start[i] = (n - b->temporal_len[i]) / 2;
+        b->temporal_offset[i] = total;
+        total += b->temporal_len[i];
+    }
+    b->temporal = malloc(total * sizeof(fft_complex_t));
+    if (!b->temporal) {
+        return false;
+    }
+    for (int i = 0; i < NUM_PIANO_NOTES; i++) {
+        int len = b->temporal_len[i];
+        for (int j = 0; j < len; j++) {
+            double w = 0.5 - 0.5 * cos(2 * M_PI * (j + 0.5) / len);
+            b->temporal[b->temporal_offset[i] + j] =
+                w / len * cexp(I * 2 * M_PI * b->cqt->frequencies[i] * (b->temporal_start[i] + j) / NOTES_SAMPLE_RATE);
+        }
+    }
+    return true;
+}
+
+// Function to build the tone-plus-noise frame of size n and its per-note reference
+static bool notes_bench_init(notes_bench_t *b, int n) {
+    memset(b, 0, sizeof(*b));
+    b->n = n;
+    b->frame = malloc(n * sizeof(double));
+    b->spectrum = malloc((n / 2 + 1) * sizeof(fft_complex_t));
+    b->plan = fft_plan_create_real(n, FFT_PRECISION_DOUBLE);
+    b->cqt = cqt_create(n, NOTES_SAMPLE_RATE, 12, 0, NUM_PIANO_NOTES);
+    if (!b->frame || !b->spectrum || !b->plan || !b->cqt || !notes_bench_init_cqt(b)) {
+        printf("Error: Unable to set up the note analyzers.\n");
+        notes_bench_free(b);
+        return false;
+    }
+
+    uint64_t rng = BENCH_SEED ^ (uint64_t)n;
+    for (int j = 0; j < n; j++) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        double x = 0.01 * ((double)(rng >> 11) / (1ULL << 53) - 0.5);
+        for (int i = 0; i < NUM_PIANO_NOTES; i += NOTES_TONE_STEP) {
+            x += 0.05 * sin(2 * M_PI * note_frequencies[i] * j / NOTES_SAMPLE_RATE);
+        }
+        b->frame[j] = x;
+    }
+    for (int i = 0; i < NUM_PIANO_NOTES; i++) {
+        b->reference[i] = dtft_energy(b->frame, n, note_frequencies[i]);
+        b->reference_harmonics[i] = b->reference[i];
+        if (2 * note_frequencies[i] < NOTES_SAMPLE_RATE / 2.0) {
+            b->reference_harmonics[i] += dtft_energy(b->frame, n, 2 * note_frequencies[i]);
+        }
+    }
+    cqt_direct(b, b->cqt_reference);
+    return true;
+}
+
+static void print_notes_csv(const notes_result_t *results, int count) {
+    printf("analyzer,n,reps,ns_per_frame,speedup_vs_fft,rel_error\n");
+    for (int i = 0; i < count; i++) {
+        const notes_result_t *r = &results[i];
+        printf("%s,%d,%ld,%.1f,%.2f,%.3e\n", r->analyzer->name, r->n, r->reps, r->ns, r->fft_ns / r->ns,
+               r->rel_error);
+    }
+}
+
+static void print_notes_json(const notes_result_t *results, int count, double min_time) {
+    printf("{\n  \"simd_width\": %d,\n  \"sample_rate\": %d,\n  \"min_time_s\": %g,\n  \"runs\": %d,\n"
+           "  \"results\": [\n", SIMD_WIDTH, NOTES_SAMPLE_RATE, min_time, BENCH_RUNS);
+    for (int i = 0; i < count; i++) {
+        const notes_result_t *r = &results[i];
+        printf("    {\"analyzer\": \"%s\", \"n\": %d, \"reps\": %ld, \"ns_per_frame\": %.1f, "
+               "\"speedup_vs_fft\": %.2f, \"rel_error\": %.3e}%s\n", r->analyzer->name, r->n, r->reps, r->ns,
+               r->fft_ns / r->ns, r->rel_error, i + 1 < count ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+// Function to measure every note analyzer for frame sizes min_n .. max_n
+static int bench_notes(int min_n, int max_n, double min_time, bool json) {
+    int num_sizes = 0;
+    for (int n = min_n; n <= max_n; n *= 2) {
+        num_sizes++;
+    }
+    notes_result_t *results = calloc((size_t)num_sizes * NUM_ANALYZERS, sizeof(notes_result_t));
+    if (!results) {
+        printf("Error: Out of memory.\n");
+        return 1;
+    }
+
+    int count = 0;
+    for (int n = min_n; n <= max_n; n *= 2) {
+        notes_bench_t b;
+        if (!notes_bench_init(&b, n)) {
+            free(results);
+            return 1;
+        }
+
+        double fft_ns = 0.0;
+        for (int a = 0; a < NUM_ANALYZERS; a++) {
+            const analyzer_t *analyzer = &analyzers[a];
+            b.analyzer = analyzer;
+            if (analyzer->type == ANALYZER_GOERTZEL) {
+                int notes[NUM_PIANO_NOTES], num_notes = 0;
+                for (int i = 0; i < NUM_PIANO_NOTES; i += analyzer->sparse ? NOTES_TONE_STEP : 1) {
+                    notes[num_notes++] = i;
+                }
+                b.bank = goertzel_bank_create(n, NOTES_SAMPLE_RATE, notes, num_notes, analyzer->harmonics);
+                if (!b.bank) {
+                    notes_bench_free(&b);
+                    free(results);
+                    return 1;
+                }
+            }
+
+            notes_result_t *r = &results[count++];
+            r->analyzer = analyzer;
+            r->n = n;
+            r->ns = notes_measure(&b, min_time, &r->reps);
+            notes_execute(&b);
+            r->rel_error = notes_relative_error(&b);
+            if (analyzer->type == ANALYZER_FFT_BINS) {
+                fft_ns = r->ns;
+            }
+            r->fft_ns = fft_ns;
+            goertzel_bank_destroy(b.bank);
+            b.bank = NULL;
+            fprintf(stderr, "%s n=%d: %.1f ns\n", analyzer->name, n, r->ns);
+        }
+        notes_bench_free(&b);
+    }
+
+    if (json) {
+        print_notes_json(results, count, min_time);
+    } else {
+        print_notes_csv(results, count);
+    }
+    free(results);
+    return 0;
+}
+
+static bool power_of_two(int n) {
+    return n >= 2 && (n & (n - 1)) == 0;
+}
+
+int main(int argc, char *argv[]) {
+    bool json = false, notes = false;
+    int min_n = BENCH_MIN_N, max_n = BENCH_MAX_N, dft_max = BENCH_DFT_MAX_N;
+    double min_time = BENCH_MIN_TIME;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else if (strcmp(argv[i], "--csv") == 0) {
+            json = false;
+        } else if (strcmp(argv[i], "--notes") == 0) {
+            notes = true;
+        } else if (strcmp(argv[i], "--min") == 0 && i + 1 < argc) {
+            min_n = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max") == 0 && i + 1 < argc) {
+            max_n = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--time") == 0 && i + 1 < argc) {
+            min_time = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--dft-max") == 0 && i + 1 < argc) {
+            dft_max = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--csv | --json] [--notes] [--min N] [--max N] [--time seconds] [--dft-max N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (!power_of_two(min_n) || !power_of_two(max_n) || min_n > max_n || min_time <= 0.0) {
+        printf("Error: Sizes must be powers of two with min <= max, and the time positive.\n");
+        return 1;
+    }
+    if (notes) {
+        return bench_notes(min_n, max_n, min_time, json);
+    }
+
+    int num_sizes = 0;
+    for (int n = min_n; n <= max_n; n *= 2) {
+        num_sizes++;
+    }
+    result_t *results = calloc((size_t)num_sizes * NUM_VARIANTS, sizeof(result_t));
+    if (!results) {
+        printf("Error: Out of memory.\n");
+        return 1;
+    }
+
+    int count = 0;
+    for (int n = min_n; n <= max_n; n *= 2) {
+        bench_t b;
+        bool run_dft = n <= dft_max;
+        if (!bench_init(&b, n, run_dft)) {
+            free(results);
+            return 1;
+        }
+
+        double dft_ns = 0.0;
+        for (int v = 0; v < NUM_VARIANTS; v++) {
+            const variant_t *variant = &variants[v];
+            if (variant->type == VARIANT_DFT && !run_dft) {
+                continue;
+            }
+            b.variant = variant;
+            b.q15_exponent = 0;
+            b.plan = variant_plan(variant, n);
+            if (variant->type != VARIANT_DFT && !b.plan) {
+                printf("Error: Unable to create FFT plan.\n");
+                bench_free(&b);
+                free(results);
+                return 1;
+            }
+
+            result_t *r = &results[count++];
+            r->variant = variant;
+            r->n = n;
+            r->ns = measure(&b, min_time, &r->reps);
+            prepare(&b);
+            execute(&b);
+            r->rel_error = relative_error(&b);
+            if (variant->type == VARIANT_DFT) {
+                dft_ns = r->ns;
+            }
+            r->dft_ns = dft_ns;
+            fft_plan_destroy(b.plan);
+            b.plan = NULL;
+            fprintf(stderr, "%s/%s/%s n=%d: %.1f ns\n", variant->transform, variant->precision, variant->kernel, n, r->ns);
+        }
+        bench_free(&b);
+    }
+
+    if (json) {
+        print_json(results, count, min_time);
+    } else {
+        print_csv(results, count);
+    }
+    free(results);
+    return 0;
+}
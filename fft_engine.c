@@ -0,0 +1,306 @@
+#include <stdlib.h>
+#include <complex.h>
+#include <math.h>
+
+#include "fft_engine.h"
+#include "fft_simd.h"
+#include "fft_fixed.h"
+#include "fft_float.h"
+
+static int is_power_of_two(int n) {
+    return n > 0 && (n & (n - 1)) == 0;
+}
+
+// Allocate a plan whose complex core has core_n points and whose twiddle
+// table covers twiddle_n-point roots of unity
+static fft_plan_t *plan_alloc(int core_n, int twiddle_n, fft_direction_t direction, fft_precision_t precision) {
+    fft_plan_t *plan = calloc(1, sizeof(*plan));
+    if (!plan) {
+        return NULL;
+    }
+    plan->direction = direction;
+    plan->precision = precision;
+    plan->kernel = FFT_KERNEL_RADIX4;
+    plan->twiddles = malloc(twiddle_n * sizeof(fft_complex_t));
+    plan->bitrev = malloc(core_n * sizeof(int));
+    if (!plan->twiddles || !plan->bitrev) {
+        fft_plan_destroy(plan);
+        return NULL;
+    }
+
+    for (int k = 0; k < twiddle_n; k++) {
+        plan->twiddles[k] = cexp(direction * I * 2 * M_PI * k / twiddle_n);
+    }
+
+    int log2n = 0;
+    while ((1 << log2n) < core_n) {
+        log2n++;
+    }
+    for (int i = 0; i < core_n; i++) {
+        int r = 0;
+        for (int b = 0; b < log2n; b++) {
+            r |= ((i >> b) & 1) << (log2n - 1 - b);
+        }
+        plan->bitrev[i] = r;
+    }
+
+    if (fft_split_init(plan, core_n, twiddle_n) != 0) {
+        fft_plan_destroy(plan);
+        return NULL;
+    }
+    if (precision == FFT_PRECISION_Q15 && fft_q15_init(plan, core_n) != 0) {
+        fft_plan_destroy(plan);
+        return NULL;
+    }
+    if (precision == FFT_PRECISION_FLOAT && fft_float_init(plan, twiddle_n) != 0) {
+        fft_plan_destroy(plan);
+        return NULL;
+    }
+
+    return plan;
+}
+
+// Function to create an FFT plan with its twiddle and bit-reversal tables
+fft_plan_t *fft_plan_create(int n, fft_direction_t direction, fft_precision_t precision) {
+    if (!is_power_of_two(n)) {
+        return NULL;
+    }
+
+    fft_plan_t *plan = plan_alloc(n, n, direction, precision);
+    if (plan) {
+        plan->n = n;
+    }
+    return plan;
+}
+
+// Function to create a real-input plan: an n/2 complex core shares the n-point twiddles
+fft_plan_t *fft_plan_create_real(int n, fft_precision_t precision) {
+    if (n < 2 || !is_power_of_two(n) || precision == FFT_PRECISION_Q15) {
+        return NULL;
+    }
+
+    fft_plan_t *plan = plan_alloc(n / 2, n, FFT_FORWARD, precision);
+    if (plan) {
+        plan->n = n;
+        plan->real = 1;
+    }
+    return plan;
+}
+
+void fft_plan_set_kernel(fft_plan_t *plan, fft_kernel_t kernel) {
+    plan->kernel = kernel;
+}
+
+void fft_plan_destroy(fft_plan_t *plan) {
+    if (!plan) return;
+    free(plan->twiddles);
+    free(plan->bitrev);
+    fft_split_free(plan);
+    fft_q15_free(plan);
+    fft_float_free(plan);
+    free(plan);
+}
+
+// Complex multiply without the C99 Annex G inf/nan recovery path
+static inline fft_complex_t cmul(fft_complex_t a, fft_complex_t b) {
+    return CMPLX(creal(a) * creal(b) - cimag(a) * cimag(b),
+                 creal(a) * cimag(b) + cimag(a) * creal(b));
+}
+
+// Multiply by exp(direction * i pi / 2): -i for forward plans, +i for inverse ones
+static inline fft_complex_t rotate_quarter(fft_complex_t z, fft_direction_t direction) {
+    if (direction == FFT_FORWARD) {
+        return CMPLX(cimag(z), -creal(z));
+    }
+    return CMPLX(-cimag(z), creal(z));
+}
+
+// Reorder the array so the butterflies can run in place
+static void bit_reverse_permute(const fft_plan_t *plan, fft_complex_t x[], int n) {
+    for (int i = 0; i < n; i++) {
+        int j = plan->bitrev[i];
+        if (i < j) {
+            fft_complex_t tmp = x[i];
+            x[i] = x[j];
+            x[j] = tmp;
+        }
+    }
+}
+
+// Radix-2 stages combining size-m/2 transforms into size-m ones, starting at m = first_m
+static void radix2_stages(const fft_complex_t *twiddles, fft_complex_t x[], int n, int tw_stride, int first_m) {
+    for (int m = first_m; m <= n; m <<= 1) {
+        int half = m / 2;
+        int stride = n / m * tw_stride;
+        for (int k = 0; k < n; k += m) {
+            for (int j = 0; j < half; j++) {
+                fft_complex_t t = cmul(twiddles[j * stride], x[k + j + half]);
+                x[k + j + half] = x[k + j] - t;
+                x[k + j] = x[k + j] + t;
+            }
+        }
+    }
+}
+
+// Radix-4 stages on bit-reversed data; a final radix-2 stage handles odd log2(n)
+static void radix4_stages(const fft_plan_t *plan, fft_complex_t x[], int n, int tw_stride) {
+    const fft_complex_t *twiddles = plan->twiddles;
+    int m = 1;
+
+    for (; 4 * m <= n; m *= 4) {
+        int stride = n / (4 * m) * tw_stride;
+        for (int k = 0; k < n; k += 4 * m) {
+            for (int j = 0; j < m; j++) {
+                // Bit-reversed order puts the 0, 2, 1, 3 mod 4 sub-transforms in that order
+                fft_complex_t a0 = x[k + j];
+                fft_complex_t a2 = cmul(twiddles[2 * j * stride], x[k + j + m]);
+                fft_complex_t a1 = cmul(twiddles[j * stride], x[k + j + 2 * m]);
+                fft_complex_t a3 = cmul(twiddles[3 * j * stride], x[k + j + 3 * m]);
+
+                fft_complex_t t0 = a0 + a2;
+                fft_complex_t t1 = a0 - a2;
+                fft_complex_t t2 = a1 + a3;
+                fft_complex_t t3 = rotate_quarter(a1 - a3, plan->direction);
+
+                x[k + j] = t0 + t2;
+                x[k + j + m] = t1 + t3;
+                x[k + j + 2 * m] = t0 - t2;
+                x[k + j + 3 * m] = t1 - t3;
+            }
+        }
+    }
+
+    if (m < n) {
+        radix2_stages(twiddles, x, n, tw_stride, 2 * m);
+    }
+}
+
+// Split-radix on bit-reversed data: X = U(n/2) + W^k Z(n/4) + W^3k Z'(n/4)
+static void split_radix(const fft_plan_t *plan, fft_complex_t x[], int n, int stride) {
+    if (n == 1) return;
+    if (n == 2) {
+        fft_complex_t t = x[1];
+        x[1] = x[0] - t;
+        x[0] = x[0] + t;
+        return;
+    }
+    if (n == 4) {
+        // Twiddle-free size-4 butterfly, inputs in 0, 2, 1, 3 order
+        fft_complex_t t0 = x[0] + x[1];
+        fft_complex_t t1 = x[0] - x[1];
+        fft_complex_t t2 = x[2] + x[3];
+        fft_complex_t t3 = rotate_quarter(x[2] - x[3], plan->direction);
+        x[0] = t0 + t2;
+        x[1] = t1 + t3;
+        x[2] = t0 - t2;
+        x[3] = t1 - t3;
+        return;
+    }
+
+    int q = n / 4;
+    split_radix(plan, x, n / 2, stride * 2);
+    split_radix(plan, x + 2 * q, q, stride * 4);
+    split_radix(plan, x + 3 * q, q, stride * 4);
+
+    const fft_complex_t *twiddles = plan->twiddles;
+    for (int k = 0; k < q; k++) {
+        fft_complex_t z = cmul(twiddles[k * stride], x[k + 2 * q]);
+        fft_complex_t zp = cmul(twiddles[3 * k * stride], x[k + 3 * q]);
+        fft_complex_t sum = z + zp;
+        fft_complex_t diff = rotate_quarter(z - zp, plan->direction);
+
+        fft_complex_t u0 = x[k];
+        fft_complex_t u1 = x[k + q];
+        x[k] = u0 + sum;
+        x[k + 2 * q] = u0 - sum;
+        x[k + q] = u1 + diff;
+        x[k + 3 * q] = u1 - diff;
+    }
+}
+
+// Transform of n points with the plan's kernel; twiddles are every tw_stride-th table entry
+static void fft_core(fft_plan_t *plan, fft_complex_t x[], int n, int tw_stride) {
+    if (plan->kernel == FFT_KERNEL_SIMD_SPLIT) {
+        fft_split_core(plan, x, n);
+        return;
+    }
+
+    bit_reverse_permute(plan, x, n);
+
+    switch (plan->kernel) {
+    case FFT_KERNEL_RADIX4:
+        radix4_stages(plan, x, n, tw_stride);
+        break;
+    case FFT_KERNEL_SPLIT_RADIX:
+        split_radix(plan, x, n, tw_stride);
+        break;
+    default:
+        radix2_stages(plan->twiddles, x, n, tw_stride, 2);
+        break;
+    }
+}
+
+// Function to perform FFT in place using the plan's tables
+void fft_plan_execute(fft_plan_t *plan, fft_complex_t x[]) {
+    fft_core(plan, x, plan->n, 1);
+}
+
+// Function to perform FFT in place on split real/imaginary arrays
+void fft_plan_execute_split(const fft_plan_t *plan, double re[], double im[]) {
+    int n = plan->n;
+    for (int i = 0; i < n; i++) {
+        int j = plan->bitrev[i];
+        if (i < j) {
+            double tr = re[i], ti = im[i];
+            re[i] = re[j];
+            im[i] = im[j];
+            re[j] = tr;
+            im[j] = ti;
+        }
+    }
+    fft_split_stages(plan, re, im, n);
+}
+
+// Function to perform a real-input FFT from samples packed in pairs
+void fft_plan_execute_real_packed(fft_plan_t *plan, fft_complex_t out[]) {
+    int m = plan->n / 2;
+    const fft_complex_t *twiddles = plan->twiddles;
+
+    // Z = FFT of the even/odd pairs, using every other n-point twiddle
+    fft_core(plan, out, m, 2);
+
+    // Split Z into the spectra of the even and odd samples and recombine:
+    // X[k] = (Z[k] + conj(Z[m-k])) / 2 - i/2 W^k (Z[k] - conj(Z[m-k]))
+    fft_complex_t z0 = out[0];
+    out[0] = creal(z0) + cimag(z0);
+    out[m] = creal(z0) - cimag(z0);
+    for (int k = 1; k <= m / 2; k++) {
+        fft_complex_t a = out[k];
+        fft_complex_t b = out[m - k];
+        // -i W^k d as a quarter-turn of cmul(): no __muldc3 libcall
+        fft_complex_t sa = 0.5 * (a + conj(b));
+        fft_complex_t da = rotate_quarter(cmul(twiddles[k], a - conj(b)), FFT_FORWARD);
+        fft_complex_t sb = 0.5 * (b + conj(a));
+        fft_complex_t db = rotate_quarter(cmul(twiddles[m - k], b - conj(a)), FFT_FORWARD);
+        out[k] = sa + 0.5 * da;
+        out[m - k] = sb + 0.5 * db;
+    }
+}
+
+// Function to perform a real-input FFT; out must hold n/2 + 1 bins
+void fft_plan_execute_real(fft_plan_t *plan, const double in[], fft_complex_t out[]) {
+    for (int k = 0; k < plan->n / 2; k++) {
+        out[k] = in[2 * k] + I * in[2 * k + 1];
+    }
+    fft_plan_execute_real_packed(plan, out);
+}
+
+// Function to convert PCM straight into packed FFT input, e.g. from mapped file pages
+void fft_pack_pcm16(fft_complex_t out[], int n, const int16_t *pcm, size_t count, int stride, double scale) {
+    for (int k = 0; k < n / 2; k++) {
+        size_t even = 2 * (size_t)k;
+        double re = even < count ? pcm[even * stride] * scale : 0.0;
+        double im = even + 1 < count ? pcm[(even + 1) * stride] * scale : 0.0;
+        out[k] = CMPLX(re, im);
+    }
+}
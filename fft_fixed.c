@@ -0,0 +1,158 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "fft_engine.h"
+#include "fft_fixed.h"
+
+// Quantize exp(direction * i 2 pi k / n) to Q15; shared by the plan tables and the reference
+static void q15_twiddle(int k, int n, fft_direction_t direction, int16_t *re, int16_t *im) {
+    double angle = direction * 2 * M_PI * k / n;
+    *re = (int16_t)lrint(cos(angle) * 32767.0);
+    *im = (int16_t)lrint(sin(angle) * 32767.0);
+}
+
+static inline int16_t saturate16(int32_t v) {
+    if (v > INT16_MAX) return INT16_MAX;
+    if (v < INT16_MIN) return INT16_MIN;
+    return (int16_t)v;
+}
+
+// Block-floating-point shift for the next stage: a radix-2 butterfly can grow a
+// component by at most 1 + sqrt(2), so keep the block maximum below 2^13
+static inline int q15_stage_shift(int32_t block_max) {
+    if (block_max < (1 << 13)) return 0;
+    if (block_max < (1 << 14)) return 1;
+    return 2;
+}
+
+int fft_q15_init(fft_plan_t *plan, int n) {
+    int count = n / 2 > 0 ? n / 2 : 1;
+    plan->q15_tw_re = malloc(count * sizeof(int16_t));
+    plan->q15_tw_im = malloc(count * sizeof(int16_t));
+    if (!plan->q15_tw_re || !plan->q15_tw_im) {
+        return -1;
+    }
+    for (int k = 0; k < n / 2; k++) {
+        q15_twiddle(k, n, plan->direction, &plan->q15_tw_re[k], &plan->q15_tw_im[k]);
+    }
+    return 0;
+}
+
+void fft_q15_free(fft_plan_t *plan) {
+    free(plan->q15_tw_re);
+    free(plan->q15_tw_im);
+}
+
+// Function to perform a Q15 FFT in place; returns the block exponent
+int fft_plan_execute_q15(const fft_plan_t *plan, fft_q15_t x[]) {
+    int n = plan->n;
+    int exponent = 0;
+    int32_t block_max = 0;
+
+    for (int i = 0; i < n; i++) {
+        int j = plan->bitrev[i];
+        if (i < j) {
+            fft_q15_t tmp = x[i];
+            x[i] = x[j];
+            x[j] = tmp;
+        }
+        int32_t mr = abs(x[i].re);
+        int32_t mi = abs(x[i].im);
+        if (mr > block_max) block_max = mr;
+        if (mi > block_max) block_max = mi;
+    }
+
+    for (int m = 2; m <= n; m <<= 1) {
+        int half = m / 2;
+        int stride = n / m;
+        int shift = q15_stage_shift(block_max);
+        int32_t round = 1 << (13 + shift);
+        exponent += shift;
+        block_max = 0;
+
+        for (int k = 0; k < n; k += m) {
+            for (int j = 0; j < half; j++) {
+                int32_t wr = plan->q15_tw_re[j * stride];
+                int32_t wi = plan->q15_tw_im[j * stride];
+                fft_q15_t *a = &x[k + j];
+                fft_q15_t *b = &x[k + j + half];
+
+                // Q15 x Q15 products summed in a 32-bit accumulator, halved to Q29
+                int32_t tr = (wr * b->re - wi * b->im) >> 1;
+                int32_t ti = (wr * b->im + wi * b->re) >> 1;
+                int32_t ar = (int32_t)a->re << 14;
+                int32_t ai = (int32_t)a->im << 14;
+
+                a->re = saturate16((ar + tr + round) >> (14 + shift));
+                a->im = saturate16((ai + ti + round) >> (14 + shift));
+                b->re = saturate16((ar - tr + round) >> (14 + shift));
+                b->im = saturate16((ai - ti + round) >> (14 + shift));
+
+                int32_t m0 = abs(a->re), m1 = abs(a->im), m2 = abs(b->re), m3 = abs(b->im);
+                if (m0 > block_max) block_max = m0;
+                if (m1 > block_max) block_max = m1;
+                if (m2 > block_max) block_max = m2;
+                if (m3 > block_max) block_max = m3;
+            }
+        }
+    }
+
+    return exponent;
+}
+
+// Straightforward Q15 FFT used to verify fft_plan_execute_q15() bit for bit:
+// naive bit reversal, a separate max scan per stage, twiddles quantized per butterfly
+int fft_q15_reference(fft_q15_t x[], int n, fft_direction_t direction) {
+    int log2n = 0;
+    while ((1 << log2n) < n) {
+        log2n++;
+    }
+
+    for (int i = 0; i < n; i++) {
+        int r = 0;
+        for (int b = 0; b < log2n; b++) {
+            r |= ((i >> b) & 1) << (log2n - 1 - b);
+        }
+        if (i < r) {
+            fft_q15_t tmp = x[i];
+            x[i] = x[r];
+            x[r] = tmp;
+        }
+    }
+
+    int exponent = 0;
+    for (int m = 2; m <= n; m <<= 1) {
+        int32_t block_max = 0;
+        for (int i = 0; i < n; i++) {
+            if (abs(x[i].re) > block_max) block_max = abs(x[i].re);
+            if (abs(x[i].im) > block_max) block_max = abs(x[i].im);
+        }
+        int shift = q15_stage_shift(block_max);
+        exponent += shift;
+
+        for (int k = 0; k < n; k += m) {
+            for (int j = 0; j < m / 2; j++) {
+                int16_t wr, wi;
+                q15_twiddle(j * (n / m), n, direction, &wr, &wi);
+                fft_q15_t a = x[k + j];
+                fft_q15_t b = x[k + j + m / 2];
+
+                int32_t tr = ((int32_t)wr * b.re - (int32_t)wi * b.im) >> 1;
+                int32_t ti = ((int32_t)wr * b.im + (int32_t)wi * b.re) >> 1;
+                int32_t sum_re = ((int32_t)a.re << 14) + tr;
+                int32_t sum_im = ((int32_t)a.im << 14) + ti;
+                int32_t diff_re = ((int32_t)a.re << 14) - tr;
+                int32_t diff_im = ((int32_t)a.im << 14) - ti;
+                int32_t round = 1 << (13 + shift);
+
+                x[k + j].re = saturate16((sum_re + round) >> (14 + shift));
+                x[k + j].im = saturate16((sum_im + round) >> (14 + shift));
+                x[k + j + m / 2].re = saturate16((diff_re + round) >> (14 + shift));
+                x[k + j + m / 2].im = saturate16((diff_im + round) >> (14 + shift));
+            }
+        }
+    }
+
+    return exponent;
+}
@@ -0,0 +1,13 @@
+#ifndef _FFT_FIXED_H
+#define _FFT_FIXED_H
+
+#include "fft_engine.h"
+
+// Internal to the FFT engine: Q15 twiddle tables for FFT_PRECISION_Q15 plans
+
+// Build the quantized twiddles for an n-point complex plan; 0 on success
+int fft_q15_init(fft_plan_t *plan, int n);
+
+void fft_q15_free(fft_plan_t *plan);
+
+#endif
@@ -0,0 +1,106 @@
+#include <stdlib.h>
+#include <complex.h>
+
+#include "fft_engine.h"
+#include "fft_float.h"
+
+int fft_float_init(fft_plan_t *plan, int twiddle_n) {
+    plan->twiddles_f = malloc(twiddle_n * sizeof(fft_complex_float_t));
+    if (!plan->twiddles_f) {
+        return -1;
+    }
+    // Twiddles are computed in double and rounded once, so they carry 0.5 ulp error
+    for (int k = 0; k < twiddle_n; k++) {
+        plan->twiddles_f[k] = (fft_complex_float_t)plan->twiddles[k];
+    }
+    return 0;
+}
+
+void fft_float_free(fft_plan_t *plan) {
+    free(plan->twiddles_f);
+}
+
+static inline fft_complex_float_t cmulf(fft_complex_float_t a, fft_complex_float_t b) {
+    return CMPLXF(crealf(a) * crealf(b) - cimagf(a) * cimagf(b),
+                  crealf(a) * cimagf(b) + cimagf(a) * crealf(b));
+}
+
+static inline fft_complex_float_t rotate_quarterf(fft_complex_float_t z, fft_direction_t direction) {
+    if (direction == FFT_FORWARD) {
+        return CMPLXF(cimagf(z), -crealf(z));
+    }
+    return CMPLXF(-cimagf(z), crealf(z));
+}
+
+// Radix-4 stages with a closing radix-2 stage, as in the double engine
+static void fft_core_float(const fft_plan_t *plan, fft_complex_float_t x[], int n, int tw_stride) {
+    const fft_complex_float_t *twiddles = plan->twiddles_f;
+
+    for (int i = 0; i < n; i++) {
+        int j = plan->bitrev[i];
+        if (i < j) {
+            fft_complex_float_t tmp = x[i];
+            x[i] = x[j];
+            x[j] = tmp;
+        }
+    }
+
+    int m = 1;
+    for (; 4 * m <= n; m *= 4) {
+        int stride = n / (4 * m) * tw_stride;
+        for (int k = 0; k < n; k += 4 * m) {
+            for (int j = 0; j < m; j++) {
+                fft_complex_float_t a0 = x[k + j];
+                fft_complex_float_t a2 = cmulf(twiddles[2 * j * stride], x[k + j + m]);
+                fft_complex_float_t a1 = cmulf(twiddles[j * stride], x[k + j + 2 * m]);
+                fft_complex_float_t a3 = cmulf(twiddles[3 * j * stride], x[k + j + 3 * m]);
+
+                fft_complex_float_t t0 = a0 + a2;
+                fft_complex_float_t t1 = a0 - a2;
+                fft_complex_float_t t2 = a1 + a3;
+                fft_complex_float_t t3 = rotate_quarterf(a1 - a3, plan->direction);
+
+                x[k + j] = t0 + t2;
+                x[k + j + m] = t1 + t3;
+                x[k + j + 2 * m] = t0 - t2;
+                x[k + j + 3 * m] = t1 - t3;
+            }
+        }
+    }
+
+    if (m < n) {
+        int stride = tw_stride;
+        for (int j = 0; j < m; j++) {
+            fft_complex_float_t t = cmulf(twiddles[j * stride], x[j + m]);
+            x[j + m] = x[j] - t;
+            x[j] = x[j] + t;
+        }
+    }
+}
+
+// Function to perform a single-precision FFT in place
+void fft_plan_execute_float(const fft_plan_t *plan, fft_complex_float_t x[]) {
+    fft_core_float(plan, x, plan->n, 1);
+}
+
+// Function to perform a single-precision real-input FFT from packed sample pairs
+void fft_plan_execute_real_float_packed(const fft_plan_t *plan, fft_complex_float_t out[]) {
+    int m = plan->n / 2;
+    const fft_complex_float_t *twiddles = plan->twiddles_f;
+
+    fft_core_float(plan, out, m, 2);
+
+    fft_complex_float_t z0 = out[0];
+    out[0] = crealf(z0) + cimagf(z0);
+    out[m] = crealf(z0) - cimagf(z0);
+    for (int k = 1; k <= m / 2; k++) {
+        fft_complex_float_t a = out[k];
+        fft_complex_float_t b = out[m - k];
+        fft_complex_float_t sa = 0.5f * (a + conjf(b));
+        fft_complex_float_t da = rotate_quarterf(cmulf(twiddles[k], a - conjf(b)), FFT_FORWARD);
+        fft_complex_float_t sb = 0.5f * (b + conjf(a));
+        fft_complex_float_t db = rotate_quarterf(cmulf(twiddles[m - k], b - conjf(a)), FFT_FORWARD);
+        out[k] = sa + 0.5f * da;
+        out[m - k] = sb + 0.5f * db;
+    }
+}
@@ -0,0 +1,13 @@
+#ifndef _FFT_FLOAT_H
+#define _FFT_FLOAT_H
+
+#include "fft_engine.h"
+
+// Internal to the FFT engine: single-precision tables for FFT_PRECISION_FLOAT plans
+
+// Round the plan's twiddle_n-entry double table to float; 0 on success
+int fft_float_init(fft_plan_t *plan, int twiddle_n);
+
+void fft_float_free(fft_plan_t *plan);
+
+#endif
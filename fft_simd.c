@@ -0,0 +1,110 @@
+#include <stdlib.h>
+#include <complex.h>
+
+#include "fft_engine.h"
+#include "fft_simd.h"
+#include "simd.h"
+
+// Twiddles for the stage of size m live at offset m / 2 - 1, contiguous in j
+int fft_split_init(fft_plan_t *plan, int core_n, int twiddle_n) {
+    int count = core_n > 1 ? core_n - 1 : 1;
+    plan->split_tw_re = malloc(count * sizeof(double));
+    plan->split_tw_im = malloc(count * sizeof(double));
+    plan->split_re = malloc(core_n * sizeof(double));
+    plan->split_im = malloc(core_n * sizeof(double));
+    if (!plan->split_tw_re || !plan->split_tw_im || !plan->split_re || !plan->split_im) {
+        return -1;
+    }
+
+    for (int m = 2; m <= core_n; m <<= 1) {
+        int half = m / 2;
+        for (int j = 0; j < half; j++) {
+            fft_complex_t w = plan->twiddles[j * (twiddle_n / m)];
+            plan->split_tw_re[half - 1 + j] = creal(w);
+            plan->split_tw_im[half - 1 + j] = cimag(w);
+        }
+    }
+    return 0;
+}
+
+void fft_split_free(fft_plan_t *plan) {
+    free(plan->split_tw_re);
+    free(plan->split_tw_im);
+    free(plan->split_re);
+    free(plan->split_im);
+}
+
+// Scalar butterflies for stages narrower than one vector
+static void split_stage_scalar(const double *wr, const double *wi, double re[], double im[], int n, int half) {
+    for (int k = 0; k < n; k += 2 * half) {
+        for (int j = 0; j < half; j++) {
+            int a = k + j;
+            int b = a + half;
+            double tr = wr[j] * re[b] - wi[j] * im[b];
+            double ti = wr[j] * im[b] + wi[j] * re[b];
+            re[b] = re[a] - tr;
+            im[b] = im[a] - ti;
+            re[a] += tr;
+            im[a] += ti;
+        }
+    }
+}
+
+#if SIMD_WIDTH > 1
+// SIMD_WIDTH butterflies per instruction; no shuffles thanks to the split layout
+static void split_stage_simd(const double *wr, const double *wi, double re[], double im[], int n, int half) {
+    for (int k = 0; k < n; k += 2 * half) {
+        for (int j = 0; j < half; j += SIMD_WIDTH) {
+            int a = k + j;
+            int b = a + half;
+            simd_t w_re = simd_load(wr + j);
+            simd_t w_im = simd_load(wi + j);
+            simd_t b_re = simd_load(re + b);
+            simd_t b_im = simd_load(im + b);
+            simd_t a_re = simd_load(re + a);
+            simd_t a_im = simd_load(im + a);
+
+            simd_t t_re = simd_sub(simd_mul(w_re, b_re), simd_mul(w_im, b_im));
+            simd_t t_im = simd_add(simd_mul(w_re, b_im), simd_mul(w_im, b_re));
+
+            simd_store(re + b, simd_sub(a_re, t_re));
+            simd_store(im + b, simd_sub(a_im, t_im));
+            simd_store(re + a, simd_add(a_re, t_re));
+            simd_store(im + a, simd_add(a_im, t_im));
+        }
+    }
+}
+#endif
+
+void fft_split_stages(const fft_plan_t *plan, double re[], double im[], int n) {
+    for (int m = 2; m <= n; m <<= 1) {
+        int half = m / 2;
+        const double *wr = plan->split_tw_re + half - 1;
+        const double *wi = plan->split_tw_im + half - 1;
+#if SIMD_WIDTH > 1
+        if (half >= SIMD_WIDTH) {
+            split_stage_simd(wr, wi, re, im, n, half);
+            continue;
+        }
+#endif
+        split_stage_scalar(wr, wi, re, im, n, half);
+    }
+}
+
+// The bit-reversal permutation is folded into the AoS -> SoA conversion
+void fft_split_core(fft_plan_t *plan, fft_complex_t x[], int n) {
+    double *re = plan->split_re;
+    double *im = plan->split_im;
+
+    for (int i = 0; i < n; i++) {
+        fft_complex_t v = x[plan->bitrev[i]];
+        re[i] = creal(v);
+        im[i] = cimag(v);
+    }
+
+    fft_split_stages(plan, re, im, n);
+
+    for (int i = 0; i < n; i++) {
+        x[i] = CMPLX(re[i], im[i]);
+    }
+}
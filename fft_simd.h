@@ -0,0 +1,19 @@
+#ifndef _FFT_SIMD_H
+#define _FFT_SIMD_H
+
+#include "fft_engine.h"
+
+// Internal to the FFT engine: split real/imag (SoA) tables and butterflies
+
+// Build the per-stage split twiddles and scratch for a core_n-point core; 0 on success
+int fft_split_init(fft_plan_t *plan, int core_n, int twiddle_n);
+
+void fft_split_free(fft_plan_t *plan);
+
+// Radix-2 stages over bit-reversed split data of n points
+void fft_split_stages(const fft_plan_t *plan, double re[], double im[], int n);
+
+// Run an interleaved core transform through the split kernel and the plan's scratch, converting at the edges
+void fft_split_core(fft_plan_t *plan, fft_complex_t x[], int n);
+
+#endif
@@ -0,0 +1,224 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "goertzel.h"
+#include "simd.h"
+
+// Independent vector recurrences per pass. A sample costs each chain one
+// multiply-add of latency (x - s2 is computed off the chain), and this many
+// chains cover it on both FP ports, with or without FMA
+#define GOERTZEL_CHAINS 8
+
+static const double goertzel_idle[SIMD_WIDTH]; // coefficients of the chains a pass leaves unused
+
+// Segments the frame splits into for a pass over the next min(vectors_left,
+// GOERTZEL_CHAINS) vectors: a short bank runs one chain per vector and segment
+static int goertzel_segments(int vectors_left) {
+    return vectors_left >= GOERTZEL_CHAINS ? 1 : GOERTZEL_CHAINS / vectors_left;
+}
+
+// Function to create a Goertzel bank tuned to a set of piano notes
+goertzel_bank_t *goertzel_bank_create(int frame_size, int sample_rate, const int *notes, int num_notes, int harmonics) {
+    bool valid = frame_size >= 1 && sample_rate >= 1 && notes && num_notes >= 1 && num_notes <= NUM_PIANO_NOTES;
+    for (int i = 0; valid && i < num_notes; i++) {
+        valid = notes[i] >= 0 && notes[i] < NUM_PIANO_NOTES && (i == 0 || notes[i] > notes[i - 1]) &&
+                note_frequencies[notes[i]] < sample_rate / 2.0;
+    }
+    if (!valid) {
+        printf("Error: Invalid Goertzel bank parameters.\n");
+        return NULL;
+    }
+
+    goertzel_bank_t *bank = calloc(1, sizeof(*bank));
+    if (!bank) {
+        return NULL;
+    }
+    // Harmonics at or above Nyquist would alias onto a lower frequency: no filter for them
+    int num_harmonics = 0;
+    while (harmonics && num_harmonics < num_notes &&
+           2 * note_frequencies[notes[num_harmonics]] < sample_rate / 2.0) {
+        num_harmonics++;
+    }
+    int count = num_notes + num_harmonics;
+    bank->frame_size = frame_size;
+    bank->num_notes = num_notes;
+    bank->harmonics = harmonics ? 1 : 0;
+    bank->num_harmonics = num_harmonics;
+    bank->num_filters = (count + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+    bank->notes = malloc(num_notes * sizeof(int));
+    bank->coeff = calloc(bank->num_filters, sizeof(double));
+    for (int m = 0; m < 3; m++) {
+        bank->carry[m] = malloc(bank->num_filters * sizeof(double));
+    }
+    bank->energy = calloc(bank->num_filters, sizeof(double));
+    if (!bank->notes || !bank->coeff || !bank->carry[0] || !bank->carry[1] || !bank->carry[2] || !bank->energy) {
+        goertzel_bank_destroy(bank);
+        return NULL;
+    }
+    memcpy(bank->notes, notes, num_notes * sizeof(int));
+
+    // Padding keeps coefficient 0, which is a working filter at fs / 4: its
+    // output is computed with the last vector but never read.
+    // A segment of length L ends in (a, b) = (s[k], s[k-1]) from a zero start;
+    // the homogeneous recurrence carries that to the end of the next segment as
+    // (U_L a - U_L-1 b, U_L-1 a - U_L-2 b), U_m = sin((m + 1) w) / sin w
+    int vectors = bank->num_filters / SIMD_WIDTH;
+    for (int v = 0; v < vectors;) {
+        int group = vectors - v < GOERTZEL_CHAINS ? vectors - v : GOERTZEL_CHAINS;
+        int length = frame_size / goertzel_segments(vectors - v);
+        for (int i = v * SIMD_WIDTH; i < (v + group) * SIMD_WIDTH; i++) {
+            double w = M_PI / 2;
+            if (i < count) {
+                double frequency = note_frequencies[notes[i % num_notes]] * (i < num_notes ? 1 : 2);
+                w = 2 * M_PI * frequency / sample_rate;
+                bank->coeff[i] = 2 * cos(w);
+            }
+            for (int m = 0; m < 3; m++) {
+                bank->carry[m][i] = sin((length + 1 - m) * w) / sin(w);
+            }
+        }
+        v += group;
+    }
+    return bank;
+}
+
+// Function to create a Goertzel bank over consecutive notes
+goertzel_bank_t *goertzel_bank_create_range(int frame_size, int sample_rate, int first_note, int num_notes,
+                                            int harmonics) {
+    int notes[NUM_PIANO_NOTES];
+    if (first_note < 0 || num_notes < 1 || first_note + num_notes > NUM_PIANO_NOTES) {
+        printf("Error: Invalid Goertzel bank parameters.\n");
+        return NULL;
+    }
+    for (int i = 0; i < num_notes; i++) {
+        notes[i] = first_note + i;
+    }
+    return goertzel_bank_create(frame_size, sample_rate, notes, num_notes, harmonics);
+}
+
+#if SIMD_WIDTH > 1
+typedef simd_t goertzel_t;
+#define goertzel_load(p) simd_load(p)
+#define goertzel_store(p, v) simd_store(p, v)
+#define goertzel_set1(x) simd_set1(x)
+#define goertzel_sub(a, b) simd_sub(a, b)
+#define goertzel_fmadd(a, b, c) simd_fmadd(a, b, c)
+#else
+typedef double goertzel_t;
+#define goertzel_load(p) (*(p))
+#define goertzel_store(p, v) (*(p) = (v))
+#define goertzel_set1(x) (x)
+#define goertzel_sub(a, b) ((a) - (b))
+#define goertzel_fmadd(a, b, c) ((a) * (b) + (c))
+#endif
+
+// Function to run GOERTZEL_CHAINS vector recurrences, chain k over length
+// samples from start[k] with the filters at coeff[k], keeping the state in registers
+static void goertzel_run(const double *const coeff[GOERTZEL_CHAINS], const double *const start[GOERTZEL_CHAINS],
+                         int length, double s1_out[][SIMD_WIDTH], double s2_out[][SIMD_WIDTH]) {
+    // The chain loops must unroll completely for the arrays to live in registers
+    goertzel_t c[GOERTZEL_CHAINS], s1[GOERTZEL_CHAINS], s2[GOERTZEL_CHAINS];
+#pragma GCC unroll 8
+    for (int k = 0; k < GOERTZEL_CHAINS; k++) {
+        c[k] = goertzel_load(coeff[k]);
+        s1[k] = goertzel_set1(0.0);
+        s2[k] = s1[k];
+    }
+
+    // s[i] = c s[i-1] + (x[i] - s[i-2]): only the multiply-add depends on the
+    // previous sample. Two samples per pass let s1 and s2 trade roles instead
+    // of being copied
+    int i = 0;
+    for (; i + 1 < length; i += 2) {
+#pragma GCC unroll 8
+        for (int k = 0; k < GOERTZEL_CHAINS; k++) {
+            s2[k] = goertzel_fmadd(c[k], s1[k], goertzel_sub(goertzel_set1(start[k][i]), s2[k]));
+        }
+#pragma GCC unroll 8
+        for (int k = 0; k < GOERTZEL_CHAINS; k++) {
+            s1[k] = goertzel_fmadd(c[k], s2[k], goertzel_sub(goertzel_set1(start[k][i + 1]), s1[k]));
+        }
+    }
+    if (i < length) {
+#pragma GCC unroll 8
+        for (int k = 0; k < GOERTZEL_CHAINS; k++) {
+            goertzel_t s0 = goertzel_fmadd(c[k], s1[k], goertzel_sub(goertzel_set1(start[k][i]), s2[k]));
+            s2[k] = s1[k];
+            s1[k] = s0;
+        }
+    }
+
+#pragma GCC unroll 8
+    for (int k = 0; k < GOERTZEL_CHAINS; k++) {
+        goertzel_store(s1_out[k], s1[k]);
+        goertzel_store(s2_out[k], s2[k]);
+    }
+}
+
+// Function to run one frame through the filter bank
+void goertzel_bank_process(goertzel_bank_t *bank, const double *frame, double note_energy[NUM_PIANO_NOTES]) {
+    int n = bank->frame_size;
+    int vectors = bank->num_filters / SIMD_WIDTH;
+
+    for (int v = 0; v < vectors;) {
+        int group = vectors - v < GOERTZEL_CHAINS ? vectors - v : GOERTZEL_CHAINS;
+        int segments = goertzel_segments(vectors - v);
+        int length = n / segments;
+
+        // Chain k runs vector v + k % group over segment k / group
+        const double *coeff[GOERTZEL_CHAINS], *start[GOERTZEL_CHAINS];
+        double s1[GOERTZEL_CHAINS][SIMD_WIDTH], s2[GOERTZEL_CHAINS][SIMD_WIDTH];
+        for (int k = 0; k < GOERTZEL_CHAINS; k++) {
+            bool used = k < group * segments;
+            coeff[k] = used ? bank->coeff + (v + k % group) * SIMD_WIDTH : goertzel_idle;
+            start[k] = used ? frame + k / group * length : frame;
+        }
+        goertzel_run(coeff, start, length, s1, s2);
+
+        // Join the segments in order, then finish the samples past segments * length
+        for (int j = 0; j < group * SIMD_WIDTH; j++) {
+            int f = v * SIMD_WIDTH + j;
+            int k = j / SIMD_WIDTH, lane = j % SIMD_WIDTH;
+            double c = bank->coeff[f];
+            double u0 = bank->carry[0][f], u1 = bank->carry[1][f], u2 = bank->carry[2][f];
+            double a = s1[k][lane], b = s2[k][lane];
+            for (int seg = 1; seg < segments; seg++) {
+                double next = u0 * a - u1 * b + s1[seg * group + k][lane];
+                b = u1 * a - u2 * b + s2[seg * group + k][lane];
+                a = next;
+            }
+            for (int i = segments * length; i < n; i++) {
+                double s0 = frame[i] + c * a - b;
+                b = a;
+                a = s0;
+            }
+            // |X|^2 = s1^2 + s2^2 - c s1 s2
+            bank->energy[f] = a * a + b * b - c * a * b;
+        }
+        v += group;
+    }
+
+    // Notes outside the bank report zero energy
+    memset(note_energy, 0, NUM_PIANO_NOTES * sizeof(double));
+    for (int i = 0; i < bank->num_notes; i++) {
+        double energy = bank->energy[i];
+        if (i < bank->num_harmonics) {
+            energy += bank->energy[bank->num_notes + i];
+        }
+        note_energy[bank->notes[i]] = energy;
+    }
+}
+
+void goertzel_bank_destroy(goertzel_bank_t *bank) {
+    if (!bank) return;
+    free(bank->notes);
+    free(bank->coeff);
+    for (int m = 0; m < 3; m++) {
+        free(bank->carry[m]);
+    }
+    free(bank->energy);
+    free(bank);
+}
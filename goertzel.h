@@ -0,0 +1,39 @@
+#ifndef _GOERTZEL_H
+#define _GOERTZEL_H
+
+#include "notes.h"
+
+// Goertzel filters at the piano note frequencies (and optionally their first
+// harmonics), evaluated several filters per instruction; banks too small to
+// fill the vector pipelines split the frame in time instead. The cost is
+// frame_size * num_filters multiply-adds, so the bank only undercuts the FFT
+// when it is restricted to the notes the material can actually contain: pass
+// just those notes, in any spread across the keyboard.
+typedef struct {
+    int frame_size;
+    int *notes;      // Index into note_frequencies[] of each filtered note, ascending
+    int num_notes;
+    int harmonics;   // 1: add the energy at 2f to each note
+    int num_harmonics; // notes with 2f below Nyquist: the lowest ones, filters num_notes onwards
+    int num_filters; // num_notes + num_harmonics, padded to whole vectors
+    double *coeff;   // 2 cos(2 pi f / fs) per filter; 0 (an fs / 4 filter, never read) for padding
+    double *carry[3]; // per filter: U_L, U_L-1, U_L-2 for its segment length L (see goertzel.c)
+    double *energy;  // per-filter output of the last frame
+} goertzel_bank_t;
+
+// Create a bank for the num_notes notes in notes[] (0 = A0, strictly ascending,
+// all below Nyquist) over frames of frame_size samples. Harmonics at or above
+// Nyquist are left out. NULL on failure
+goertzel_bank_t *goertzel_bank_create(int frame_size, int sample_rate, const int *notes, int num_notes, int harmonics);
+
+// Same for the consecutive notes first_note .. first_note + num_notes - 1
+goertzel_bank_t *goertzel_bank_create_range(int frame_size, int sample_rate, int first_note, int num_notes,
+                                            int harmonics);
+
+// Run one frame through every filter; note_energy[i] is |X(f_i)|^2 (+ |X(2 f_i)|^2)
+// for the bank's notes and 0 for the others
+void goertzel_bank_process(goertzel_bank_t *bank, const double *frame, double note_energy[NUM_PIANO_NOTES]);
+
+void goertzel_bank_destroy(goertzel_bank_t *bank);
+
+#endif
@@ -21,30 +21,63 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include <time.h>
+
+#include "fft_engine.h"
+#include "sdft.h"
+#include "notes.h"
+#include "peak.h"
+#include "capture_ring.h"
+#include "audio_ring.h"
+#include "audio_uio.h"
+#include <pthread.h>
 
 // Define constants
 #define SAMPLE_RATE 48000
 #define CHUNK_SIZE 4096
+#define NUM_BINS (CHUNK_SIZE / 2 + 1) // Non-redundant bins of a real-input FFT
 #define MIN_SEGMENT_DURATION_SEC 2
 #define MAX_SEGMENT_DURATION_SEC 2
 //#define FILENAME "HCB.wav"
 #define FRACTIONAL_BITS 14
+#define LIVE_LOWER_BIN 1   // Bins tracked per sample: same band as the bandpass filter
+#define LIVE_UPPER_BIN 360
+#define LIVE_DISPLAY_SAMPLES 256 // Capture piece and display refresh: every 5.3 ms of audio
+#define LIVE_BLOCKS 16     // LIVE_DISPLAY_SAMPLES-sample pieces buffered between capture and the live display
+#define NUM_TOP_PEAKS 3
+#define PEAK_THRESHOLD 0.05          // Of the normalized spectrum: ignore peaks 26 dB below the strongest
+#define PEAK_MIN_DISTANCE_CENTS 50.0 // At most one peak per note
+#define CAPTURE_BLOCKS 16   // CHUNK_SIZE-sample timestamped blocks buffered between capture and analysis
+#define STATS_INTERVAL 64   // Report ring counters every this many analyzed blocks
+#define AUDIO_SIMULATED 0   // 1: capture from a simulated 440 Hz device instead of the driver's ring
+#define AUDIO_CAPTURE_UIO 0 // 1: load the data register directly (driver loaded with uio=1)
 
 int audio_data_fd;
 int vga_ball_fd;
+fft_plan_t *fft_plan;
+sdft_t *live_sdft;
+peak_picker_t *peak_picker;
+capture_ring_t *capture_ring;
+capture_ring_t *live_ring;
+audio_ring_t *audio_ring;
+audio_uio_t *audio_uio;
 
 
 // Define types
 typedef int32_t fixed_point_t;
-typedef complex double fft_complex_t;
 
 // Function declarations
 bool read_audio(const char *filename, fixed_point_t *samples, int *num_samples);
-void apply_fft(fixed_point_t *samples, fft_complex_t *fft_output, int num_samples);
+void apply_fft(fft_plan_t *plan, fixed_point_t *samples, fft_complex_t *fft_output, int num_samples);
 void analyze_frequency_spectrum(fft_complex_t *fft_output, int num_samples);
-const char *map_frequency_to_note(double frequency);
 void apply_bandpass_filter(fft_complex_t magnitude_spectrum[], int lower_bin, int upper_bin);
 void process_audio(audio_data_t samples[]);
+void update_live_spectrum(const audio_data_bulk_t *piece);
+void show_live_spectrum(void);
+void set_background_color(const vga_ball_color_t *c);
+bool capture_piece(audio_data_bulk_t *piece, int count);
+void *capture_main(void *arg);
+void *live_main(void *arg);
 
 int main()
 {
@@ -76,19 +109,110 @@ int main()
     return -1;
   }
 
+  fft_plan = fft_plan_create_real(CHUNK_SIZE, FFT_PRECISION_DOUBLE);
+  if (!fft_plan) {
+    fprintf(stderr, "could not create FFT plan\n");
+    return -1;
+  }
+
+  int live_bins[LIVE_UPPER_BIN - LIVE_LOWER_BIN + 1];
+  for (i = 0; i <= LIVE_UPPER_BIN - LIVE_LOWER_BIN; i++)
+    live_bins[i] = LIVE_LOWER_BIN + i;
+  live_sdft = sdft_create(CHUNK_SIZE, live_bins, LIVE_UPPER_BIN - LIVE_LOWER_BIN + 1);
+  if (!live_sdft) {
+    fprintf(stderr, "could not create sliding DFT\n");
+    return -1;
+  }
+
+  peak_picker = peak_picker_create(CHUNK_SIZE / 2, NUM_TOP_PEAKS);
+  if (!peak_picker) {
+    fprintf(stderr, "could not create peak picker\n");
+    return -1;
+  }
+  peak_picker->threshold = PEAK_THRESHOLD;
+  peak_picker->min_distance_cents = PEAK_MIN_DISTANCE_CENTS;
+
+  if (AUDIO_CAPTURE_UIO) {
+    audio_uio = audio_uio_open(SAMPLE_RATE);
+    if (!audio_uio) {
+      fprintf(stderr, "could not map the audio registers\n");
+      return -1;
+    }
+    /* Start sampling on the driver's block boundary */
+    audio_uio_wait(audio_uio);
+  } else {
+    audio_ring = AUDIO_SIMULATED ? audio_ring_open_simulated(SAMPLE_RATE, 440.0) : audio_ring_open(vga_ball_fd);
+    if (!audio_ring) {
+      fprintf(stderr, "could not map the sample ring\n");
+      return -1;
+    }
+    /* Wake the capture thread for every live piece, not once per analysis block */
+    if (!audio_ring_set_watermark(audio_ring, LIVE_DISPLAY_SAMPLES)) {
+      fprintf(stderr, "could not set the ring watermark\n");
+      return -1;
+    }
+  }
+
+  capture_ring = capture_ring_create(CAPTURE_BLOCKS, sizeof(audio_data_bulk_t));
+  if (!capture_ring) {
+    fprintf(stderr, "could not create capture ring\n");
+    return -1;
+  }
+  /* A block is due every CHUNK_SIZE sample periods; waiting longer is an underrun */
+  capture_ring_set_deadline(capture_ring, CHUNK_SIZE * 1000000000LL / SAMPLE_RATE);
+  live_ring = capture_ring_create(LIVE_BLOCKS, sizeof(audio_data_bulk_t));
+  if (!live_ring) {
+    fprintf(stderr, "could not create live ring\n");
+    return -1;
+  }
+
   printf("initial state: ");
   print_background_color();
   
   print_audio();
-  
+
+  // Capture runs on its own thread so slow analysis cannot starve the device,
+  // and the live display on another so it follows the pieces as they land
+  pthread_t capture_thread, live_thread;
+  if (pthread_create(&capture_thread, NULL, capture_main, NULL) != 0 ||
+      pthread_create(&live_thread, NULL, live_main, NULL) != 0) {
+    fprintf(stderr, "could not start capture thread\n");
+    return -1;
+  }
+
+  unsigned long analyzed = 0;
+  unsigned long long next_sequence = 0, gap_samples = 0;
+  double latency_total = 0.0, latency_max = 0.0;
   while(1){
-    colors[i%COLORS].x = x;
-    colors[i%COLORS].y = y;
-    set_background_color(&colors[i % COLORS ]);
-    audio = read_audio(audio);
-    process_audio(audio);
-    
-    usleep(20000);
+    audio_data_bulk_t *block = capture_ring_read_wait(capture_ring);
+
+    /* Samples missing between blocks: dropped by the driver or the capture ring */
+    if (analyzed > 0 && block->sequence > next_sequence)
+      gap_samples += block->sequence - next_sequence;
+    next_sequence = block->sequence + block->count;
+
+    process_audio(block->data);
+
+    /* ADC-to-note latency: from the block's last sample to its notes being out */
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double latency = (now.tv_sec * 1000000000LL + now.tv_nsec - block->timestamp_ns) * 1e-9 -
+                     (double)(block->count - 1) / SAMPLE_RATE;
+    latency_total += latency;
+    if (latency > latency_max)
+      latency_max = latency;
+    capture_ring_read_release(capture_ring);
+
+    if (++analyzed % STATS_INTERVAL == 0) {
+      capture_ring_stats_t stats;
+      capture_ring_stats(capture_ring, &stats);
+      printf("capture: %lu blocks, %lu overruns, %lu underruns, fill %d/%d (max %d)\n",
+             stats.captured, stats.overruns, stats.underruns, stats.fill, stats.capacity, stats.max_fill);
+      printf("latency: avg %.1f ms, max %.1f ms; %llu samples missing\n",
+             latency_total / analyzed * 1e3, latency_max * 1e3, gap_samples);
+      if (audio_uio)
+        printf("uio: %llu sample ticks missed by a late capture\n", (unsigned long long)audio_uio->missed);
+    }
   }
   // for (i = 0 ; i < 24 ; i++) {
   //   set_background_color(&colors[i % COLORS ]);
@@ -188,84 +312,17 @@ bool read_audio(const char *filename, fixed_point_t *samples, int *num_samples)
 }
 
 
-// Function to apply FFT to audio samples
-void apply_fft(fixed_point_t *samples, fft_complex_t *fft_output, int num_samples) {
-    if (num_samples <= 1) return;
-
-    // Divide
-    int m = num_samples / 2;
-    fixed_point_t even[m], odd[m]; // Changed from fft_complex_t to fixed_point_t
-    for (int i = 0; i < m; i++) {
-        even[i] = samples[i * 2];
-        odd[i] = samples[i * 2 + 1];
-    }
-
-    // Conquer
-    apply_fft(even, fft_output, m);
-    apply_fft(odd, fft_output + m, m);
-
-    // Combine
-    for (int i = 0; i < m; i++) {
-        fft_complex_t t = cexp(-I * 2 * M_PI * i / num_samples) * odd[i];
-        fft_output[i] = even[i] + t;
-        fft_output[i + m] = even[i] - t;
+// Function to apply a real-input FFT to audio samples (fft_output holds num_samples / 2 + 1 bins)
+void apply_fft(fft_plan_t *plan, fixed_point_t *samples, fft_complex_t *fft_output, int num_samples) {
+    // Pack sample pairs straight into the output so no widened copy is needed
+    for (int i = 0; i < num_samples / 2; i++) {
+        fft_output[i] = samples[2 * i] + I * samples[2 * i + 1];
     }
+    fft_plan_execute_real_packed(plan, fft_output);
 }
 
 
 
-// Function to map frequency to piano note
-const char *map_frequency_to_note(double frequency) {
-    // Array of piano note frequencies
-    const double note_frequencies[] = {
-        /* Frequency values of piano notes */
-        27.50, 29.14, 30.87, 32.70, 34.65, 36.71, 38.89, 41.20, 43.65, 46.25, 49.00, 51.91, 
-        55.00, 58.27, 61.74, 65.41, 69.30, 73.42, 77.78, 82.41, 87.31, 92.50, 98.00, 103.83, 
-        110.00, 116.54, 123.47, 130.81, 138.59, 146.83, 155.56, 164.81, 174.61, 185.00, 196.00, 
-        207.65, 220.00, 233.08, 246.94, 261.63, 277.18, 293.66, 311.13, 329.63, 349.23, 369.99, 
-        392.00, 415.30, 440.00, 466.16, 493.88, 523.25, 554.37, 587.33, 622.25, 659.26, 698.46, 
-        739.99, 783.99, 830.61, 880.00, 932.33, 987.77, 1046.50, 1108.73, 1174.66, 1244.51, 1318.51, 
-        1396.91, 1479.98, 1567.98, 1661.22, 1760.00, 1864.66, 1975.53, 2093.00, 2217.46, 2349.32, 
-        2489.02, 2637.02, 2793.83, 2959.96, 3135.96, 3322.44, 3520.00, 3729.31, 3951.07, 4186.01
-    };
-
-    // Array of piano note names
-    const char* note_names[] = {
-        /* Names of piano notes */
-        "A0", "A#0/Bb0", "B0", "C1", "C#1/Db1", "D1", "D#1/Eb1", "E1", "F1", "F#1/Gb1", "G1", "G#1/Ab1",
-        "A1", "A#1/Bb1", "B1", "C2", "C#2/Db2", "D2", "D#2/Eb2", "E2", "F2", "F#2/Gb2", "G2", "G#2/Ab2",
-        "A2", "A#2/Bb2", "B2", "C3", "C#3/Db3", "D3", "D#3/Eb3", "E3", "F3", "F#3/Gb3", "G3", "G#3/Ab3",
-        "A3", "A#3/Bb3", "B3", "C4", "C#4/Db4", "D4", "D#4/Eb4", "E4", "F4", "F#4/Gb4", "G4", "G#4/Ab4",
-        "A4", "A#4/Bb4", "B4", "C5", "C#5/Db5", "D5", "D#5/Eb5", "E5", "F5", "F#5/Gb5", "G5", "G#5/Ab5",
-        "A5", "A#5/Bb5", "B5", "C6", "C#6/Db6", "D6", "D#6/Eb6", "E6", "F6", "F#6/Gb6", "G6", "G#6/Ab6",
-        "A6", "A#6/Bb6", "B6", "C7", "C#7/Db7", "D7", "D#7/Eb7", "E7", "F7", "F#7/Gb7", "G7", "G#7/Ab7",
-        "A7", "A#7/Bb7", "B7", "C8"
-    };
-
-    // Find the nearest note frequency
-    double nearest_frequency = note_frequencies[0];
-    double min_difference = fabs(frequency - nearest_frequency);
-    for (int i = 1; i < sizeof(note_frequencies) / sizeof(note_frequencies[0]); i++) {
-        double difference = fabs(frequency - note_frequencies[i]);
-        if (difference < min_difference) {
-            nearest_frequency = note_frequencies[i];
-            min_difference = difference;
-        }
-    }
-
-    // Find the index of the nearest frequency in the note frequencies array
-    int index = 0;
-    for (int i = 0; i < sizeof(note_frequencies) / sizeof(note_frequencies[0]); i++) {
-        if (note_frequencies[i] == nearest_frequency) {
-            index = i;
-            break;
-        }
-    }
-
-    // Return the corresponding note name
-    return note_names[index];
-}
-
 void analyze_frequency_spectrum(fft_complex_t *fft_output, int num_samples) {
     // Calculate the bin width and maximum frequency
     double bin_width = (double)SAMPLE_RATE / num_samples;
@@ -280,48 +337,35 @@ void analyze_frequency_spectrum(fft_complex_t *fft_output, int num_samples) {
         magnitudes[i] = magnitude;
     }
 
-    // Find the top three frequencies
-    double top_magnitudes[3] = {0};
-    double top_frequencies[3] = {0};
-    int top_indices[3] = {-1, -1, -1}; // Stores the indices of the top frequencies
-    for (int i = 0; i < num_samples / 2; i++) {
-        if (magnitudes[i] > top_magnitudes[0]) {
-            top_magnitudes[2] = top_magnitudes[1];
-            top_indices[2] = top_indices[1];
-            top_magnitudes[1] = top_magnitudes[0];
-            top_indices[1] = top_indices[0];
-            top_magnitudes[0] = magnitudes[i];
-            top_indices[0] = i;
-        } else if (magnitudes[i] > top_magnitudes[1]) {
-            top_magnitudes[2] = top_magnitudes[1];
-            top_indices[2] = top_indices[1];
-            top_magnitudes[1] = magnitudes[i];
-            top_indices[1] = i;
-        } else if (magnitudes[i] > top_magnitudes[2]) {
-            top_magnitudes[2] = magnitudes[i];
-            top_indices[2] = i;
-        }
+    // Find the strongest peaks, at most one per note
+    peak_t peaks[NUM_TOP_PEAKS];
+    double top_frequencies[NUM_TOP_PEAKS];
+    int num_peaks = peak_picker_find(peak_picker, magnitudes, peaks);
+    for (int i = 0; i < num_peaks; i++) {
+        top_frequencies[i] = peak_interpolate(magnitudes, num_samples / 2, peaks[i].bin, PEAK_INTERP_GAUSSIAN) * bin_width;
     }
-    for(int i = 0; i < 3; i++) {
-    	top_frequencies[i] = top_indices[i] * bin_width;
-        }
-    // Print the top three frequencies
-    for (int i = 0; i < 3; i++) {
+
+    // Print the top frequencies
+    for (int i = 0; i < num_peaks; i++) {
         printf("Top Frequency %d: %.2f Hz\n", i + 1, top_frequencies[i]);
     }
 
     // Map frequencies to notes and print
-    for (int i = 0; i < 3; i++) {
-        double frequency = top_frequencies[i];
-        const char *note = map_frequency_to_note(frequency);
-        printf("Mapped Note %d: %s\n", i + 1, note);
+    note_map_t notes[NUM_TOP_PEAKS];
+    note_map_frequencies(top_frequencies, num_peaks, notes);
+    for (int i = 0; i < num_peaks; i++) {
+        if (notes[i].note < 0) {
+            printf("Mapped Note %d: none\n", i + 1);
+        } else {
+            printf("Mapped Note %d: %s (%+.0f cents)\n", i + 1, note_names[notes[i].note], notes[i].cents);
+        }
     }
 }
 
 
 //Bandpass Filter
 void apply_bandpass_filter(fft_complex_t magnitude_spectrum[], int lower_bin, int upper_bin) {
-    for (int i = 0; i < CHUNK_SIZE; i++) {
+    for (int i = 0; i < NUM_BINS; i++) {
         if (i < lower_bin || i > upper_bin) {
             magnitude_spectrum[i] = 0; // Zero out frequencies outside the bandpass range
         }
@@ -331,8 +375,8 @@ void apply_bandpass_filter(fft_complex_t magnitude_spectrum[], int lower_bin, in
 // Function to process audio file
 void process_audio(audio_data_t samples[]){//const char *filename) {
     //fixed_point_t samples[CHUNK_SIZE];
-    fft_complex_t fft_output[CHUNK_SIZE];
-    fft_complex_t fft_temp[CHUNK_SIZE];
+    fft_complex_t fft_output[NUM_BINS] = {0};
+    fft_complex_t fft_temp[NUM_BINS];
 
     // Open the audio file
    // FILE *file = fopen(filename, "rb");
@@ -363,9 +407,9 @@ void process_audio(audio_data_t samples[]){//const char *filename) {
         while(segment_duration1 < MIN_SEGMENT_DURATION_SEC){
         
         	// Apply FFT to the chunk
-        	apply_fft(samples, fft_temp, CHUNK_SIZE);
+        	apply_fft(fft_plan, samples, fft_temp, CHUNK_SIZE);
         
-        	for (int i = 0; i < CHUNK_SIZE; i++) {
+        	for (int i = 0; i < NUM_BINS; i++) {
     			fft_output[i] += fft_temp[i]; 
 			}
         	// Update segment duration
@@ -377,7 +421,7 @@ void process_audio(audio_data_t samples[]){//const char *filename) {
         //printf("%f\n", segment_duration);
         
         //Normalize attempt 1:
-        normalize_fft_output(fft_output, CHUNK_SIZE);
+        normalize_fft_output(fft_output, NUM_BINS);
         
         apply_bandpass_filter(fft_output, 1, 360);
         
@@ -407,7 +451,7 @@ void process_audio(audio_data_t samples[]){//const char *filename) {
         analyze_frequency_spectrum(fft_output, CHUNK_SIZE);
         
         //clear FFT array for processing the next chunk
-        for (int i = 0; i < CHUNK_SIZE; i++) {
+        for (int i = 0; i < NUM_BINS; i++) {
     			fft_output[i] = 0;
 			}
 
@@ -419,6 +463,112 @@ void process_audio(audio_data_t samples[]){//const char *filename) {
    // fclose(file);
 }
 
+// Slide the live spectrum over a newly captured piece: O(bins) work per sample,
+// with the display refreshed each time the sample clock crosses a multiple of
+// LIVE_DISPLAY_SAMPLES
+void update_live_spectrum(const audio_data_bulk_t *piece) {
+    for (uint32_t i = 0; i < piece->count; i++) {
+        // Unsigned 8-bit device samples are centred on 128
+        sdft_push(live_sdft, (piece->data[i].data - 128) / 128.0);
+    }
+    if ((piece->sequence + piece->count) / LIVE_DISPLAY_SAMPLES != piece->sequence / LIVE_DISPLAY_SAMPLES) {
+        show_live_spectrum();
+    }
+}
+
+// Show the strongest live bin: its pitch class picks the color, its bin the x position
+void show_live_spectrum(void) {
+    static const vga_ball_color_t pitch_colors[12] = {
+        {.red = 0xff, .green = 0x00, .blue = 0x00}, {.red = 0xff, .green = 0x80, .blue = 0x00},
+        {.red = 0xff, .green = 0xff, .blue = 0x00}, {.red = 0x80, .green = 0xff, .blue = 0x00},
+        {.red = 0x00, .green = 0xff, .blue = 0x00}, {.red = 0x00, .green = 0xff, .blue = 0x80},
+        {.red = 0x00, .green = 0xff, .blue = 0xff}, {.red = 0x00, .green = 0x80, .blue = 0xff},
+        {.red = 0x00, .green = 0x00, .blue = 0xff}, {.red = 0x80, .green = 0x00, .blue = 0xff},
+        {.red = 0xff, .green = 0x00, .blue = 0xff}, {.red = 0xff, .green = 0x00, .blue = 0x80},
+    };
+    int best = -1;
+    double best_power = 0.0;
+    for (int k = 0; k < live_sdft->num_bins; k++) {
+        double power = creal(live_sdft->spectrum[k]) * creal(live_sdft->spectrum[k]) +
+                       cimag(live_sdft->spectrum[k]) * cimag(live_sdft->spectrum[k]);
+        if (power > best_power) {
+            best_power = power;
+            best = k;
+        }
+    }
+    if (best < 0) {
+        return;
+    }
+
+    note_map_t note = note_map_frequency((double)live_sdft->bins[best] * SAMPLE_RATE / CHUNK_SIZE);
+    if (note.note < 0) {
+        return;
+    }
+    vga_ball_color_t color = pitch_colors[note.note % 12]; // note 0 is A0
+    color.x = (unsigned char)(best * 255 / (live_sdft->num_bins - 1));
+    color.y = 0;
+    set_background_color(&color);
+}
+
+/*
+ * Read up to LIVE_DISPLAY_SAMPLES (and at most count) samples, with the
+ * sample clock tick and time of the first, in one AUDIO_DATA_READ_BULK. The
+ * ring's watermark is one piece, so the ioctl returns as soon as the driver
+ * has one; a signal can make it short. In UIO mode the piece is sampled
+ * straight from the register instead.
+ */
+bool capture_piece(audio_data_bulk_t *piece, int count) {
+  piece->count = count < LIVE_DISPLAY_SAMPLES ? count : LIVE_DISPLAY_SAMPLES;
+  if (audio_uio)
+    return audio_uio_read_bulk(audio_uio, piece);
+  return audio_ring_read_bulk(audio_ring, piece);
+}
+
+/*
+ * Capture thread: build analysis blocks a piece at a time, handing every
+ * piece to the live display as it lands. A piece that does not continue the
+ * block starts it again, so blocks stay contiguous and the gap shows in their
+ * sequence. A full ring drops the newest block or piece.
+ */
+void *capture_main(void *arg) {
+  (void)arg;
+  while (1) {
+    audio_data_bulk_t *block = capture_ring_write_begin(capture_ring);
+    block->count = 0;
+    while (block->count < CHUNK_SIZE) {
+      audio_data_bulk_t *piece = capture_ring_write_begin(live_ring);
+      if (!capture_piece(piece, CHUNK_SIZE - block->count)) {
+        usleep(1000);
+        continue;
+      }
+      if (piece->count == 0)
+        continue;
+      if (block->count == 0 || piece->sequence != block->sequence + block->count) {
+        block->sequence = piece->sequence;
+        block->timestamp_ns = piece->timestamp_ns;
+        block->count = 0;
+      }
+      memcpy(block->data + block->count, piece->data, piece->count * sizeof(audio_data_t));
+      block->count += piece->count;
+      block->overruns = piece->overruns;
+      capture_ring_write_commit(live_ring);
+    }
+    capture_ring_write_commit(capture_ring);
+  }
+  return NULL;
+}
+
+/* Live display thread: slide the live spectrum over each piece as it arrives */
+void *live_main(void *arg) {
+  (void)arg;
+  while (1) {
+    audio_data_bulk_t *piece = capture_ring_read_wait(live_ring);
+    update_live_spectrum(piece);
+    capture_ring_read_release(live_ring);
+  }
+  return NULL;
+}
+
 /* Read and print the background color */
 void print_background_color() {
   vga_ball_arg_t vla;
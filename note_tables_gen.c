@@ -0,0 +1,35 @@
+#include <stdio.h>
+
+#include "notes.h"
+
+// Standard (FFT size, sample rate) configurations baked into note_tables.c
+static const int configs[][2] = {
+    {4096, 48000},
+    {8192, 48000}
+};
+#define NUM_CONFIGS (int)(sizeof(configs) / sizeof(configs[0]))
+
+// Regenerate with: ./note_tables_gen > note_tables.c
+int main() {
+    printf("// Generated by note_tables_gen.c; do not edit\n");
+    printf("#include <stddef.h>\n\n#include \"notes.h\"\n");
+
+    for (int c = 0; c < NUM_CONFIGS; c++) {
+        int n = configs[c][0];
+        int sample_rate = configs[c][1];
+        printf("\nstatic const note_map_t bins_%d_%d[%d] = {", n, sample_rate, n / 2 + 1);
+        for (int k = 0; k <= n / 2; k++) {
+            note_map_t map = note_map_frequency((double)k * sample_rate / n);
+            printf("%s{%d, %.9g}", k == 0 ? "\n    " : k % 6 == 0 ? ",\n    " : ", ", map.note, map.cents);
+        }
+        printf("\n};\n");
+    }
+
+    printf("\nconst note_map_t *note_bin_table_lookup(int n, int sample_rate) {\n");
+    for (int c = 0; c < NUM_CONFIGS; c++) {
+        printf("    if (n == %d && sample_rate == %d) return bins_%d_%d;\n",
+               configs[c][0], configs[c][1], configs[c][0], configs[c][1]);
+    }
+    printf("    return NULL;\n}\n");
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include <stdlib.h>
+#include <math.h>
+
+#include "notes.h"
+
+// Array of piano note frequencies
+const double note_frequencies[NUM_PIANO_NOTES] = {
+    27.50, 29.14, 30.87, 32.70, 34.65, 36.71, 38.89, 41.20, 43.65, 46.25, 49.00, 51.91,
+    55.00, 58.27, 61.74, 65.41, 69.30, 73.42, 77.78, 82.41, 87.31, 92.50, 98.00, 103.83,
+    110.00, 116.54, 123.47, 130.81, 138.59, 146.83, 155.56, 164.81, 174.61, 185.00, 196.00,
+    207.65, 220.00, 233.08, 246.94, 261.63, 277.18, 293.66, 311.13, 329.63, 349.23, 369.99,
+    392.00, 415.30, 440.00, 466.16, 493.88, 523.25, 554.37, 587.33, 622.25, 659.26, 698.46,
+    739.99, 783.99, 830.61, 880.00, 932.33, 987.77, 1046.50, 1108.73, 1174.66, 1244.51, 1318.51,
+    1396.91, 1479.98, 1567.98, 1661.22, 1760.00, 1864.66, 1975.53, 2093.00, 2217.46, 2349.32,
+    2489.02, 2637.02, 2793.83, 2959.96, 3135.96, 3322.44, 3520.00, 3729.31, 3951.07, 4186.01
+};
+
+// Array of piano note names
+const char *const note_names[NUM_PIANO_NOTES] = {
+    "A0", "A#0/Bb0", "B0", "C1", "C#1/Db1", "D1", "D#1/Eb1", "E1", "F1", "F#1/Gb1", "G1", "G#1/Ab1",
+    "A1", "A#1/Bb1", "B1", "C2", "C#2/Db2", "D2", "D#2/Eb2", "E2", "F2", "F#2/Gb2", "G2", "G#2/Ab2",
+    "A2", "A#2/Bb2", "B2", "C3", "C#3/Db3", "D3", "D#3/Eb3", "E3", "F3", "F#3/Gb3", "G3", "G#3/Ab3",
+    "A3", "A#3/Bb3", "B3", "C4", "C#4/Db4", "D4", "D#4/Eb4", "E4", "F4", "F#4/Gb4", "G4", "G#4/Ab4",
+    "A4", "A#4/Bb4", "B4", "C5", "C#5/Db5", "D5", "D#5/Eb5", "E5", "F5", "F#5/Gb5", "G5", "G#5/Ab5",
+    "A5", "A#5/Bb5", "B5", "C6", "C#6/Db6", "D6", "D#6/Eb6", "E6", "F6", "F#6/Gb6", "G6", "G#6/Ab6",
+    "A6", "A#6/Bb6", "B6", "C7", "C#7/Db7", "D7", "D#7/Eb7", "E7", "F7", "F#7/Gb7", "G7", "G#7/Ab7",
+    "A7", "A#7/Bb7", "B7", "C8"
+};
+
+// Function to map a frequency to its nearest note and cents offset
+note_map_t note_map_frequency(double frequency) {
+    note_map_t map = {-1, 0.0f};
+    if (!(frequency > 0.0)) {
+        return map;
+    }
+    double semitones = 12.0 * log2(frequency / NOTE_A0_FREQUENCY);
+    double nearest = floor(semitones + 0.5);
+    if (nearest >= 0 && nearest < NUM_PIANO_NOTES) {
+        map.note = (int)nearest;
+        map.cents = (float)(100.0 * (semitones - nearest));
+    }
+    return map;
+}
+
+// Function to map a batch of peak frequencies
+void note_map_frequencies(const double *frequencies, int count, note_map_t *out) {
+    for (int i = 0; i < count; i++) {
+        out[i] = note_map_frequency(frequencies[i]);
+    }
+}
+
+// Function to map frequency to piano note
+const char *map_frequency_to_note(double frequency) {
+    note_map_t map = note_map_frequency(frequency);
+    if (map.note < 0) {
+        return frequency < NOTE_A0_FREQUENCY ? note_names[0] : note_names[NUM_PIANO_NOTES - 1];
+    }
+    return note_names[map.note];
+}
+
+// Function to build the bin-to-note table for one transform size
+note_map_t *note_bin_table_create(int n, int sample_rate) {
+    note_map_t *table = malloc((n / 2 + 1) * sizeof(note_map_t));
+    if (!table) {
+        return NULL;
+    }
+    for (int k = 0; k <= n / 2; k++) {
+        table[k] = note_map_frequency((double)k * sample_rate / n);
+    }
+    return table;
+}
@@ -0,0 +1,32 @@
+#ifndef _NOTES_H
+#define _NOTES_H
+
+#define NUM_PIANO_NOTES 88 // A0 (27.50 Hz) .. C8 (4186.01 Hz)
+#define NOTE_A0_FREQUENCY 27.5
+
+// Piano note frequencies in Hz and their names, A0 first
+extern const double note_frequencies[NUM_PIANO_NOTES];
+extern const char *const note_names[NUM_PIANO_NOTES];
+
+// Nearest equal-tempered note and the offset from it
+typedef struct {
+    int note;    // index into note_frequencies[]; -1 more than 50 cents outside the keyboard
+    float cents; // -50 .. +50 from the note (0 when note is -1)
+} note_map_t;
+
+// Closed-form nearest note: round(12 log2(f / 27.5)), no table scan
+note_map_t note_map_frequency(double frequency);
+
+// Map count frequencies at once
+void note_map_frequencies(const double *frequencies, int count, note_map_t *out);
+
+// Name of the nearest note; frequencies outside the keyboard clamp to A0 / C8
+const char *map_frequency_to_note(double frequency);
+
+// Note of every bin 0 .. n / 2 of an n-point FFT at sample_rate (free() when done)
+note_map_t *note_bin_table_create(int n, int sample_rate);
+
+// Precomputed table for a standard configuration (note_tables.c), NULL if not built in
+const note_map_t *note_bin_table_lookup(int n, int sample_rate);
+
+#endif
@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <complex.h>
+#include <math.h>
+
+#include "peak.h"
+#include "simd.h"
+
+// Function to refine a spectral peak to a fractional bin
+double peak_interpolate(const double *magnitude, int num_bins, int k, peak_interp_t method) {
+    if (method == PEAK_INTERP_NONE || k <= 0 || k >= num_bins - 1) {
+        return k;
+    }
+
+    double a = magnitude[k - 1];
+    double b = magnitude[k];
+    double c = magnitude[k + 1];
+    if (method == PEAK_INTERP_GAUSSIAN) {
+        // log(0) would poison the fit: a zero neighbour leaves the peak unrefined
+        if (a <= 0.0 || b <= 0.0 || c <= 0.0) {
+            return k;
+        }
+        a = log(a);
+        b = log(b);
+        c = log(c);
+    }
+
+    // Vertex of the parabola through (-1, a), (0, b), (1, c)
+    double denominator = a - 2 * b + c;
+    if (denominator >= 0.0) {
+        return k; // not a maximum
+    }
+    double delta = 0.5 * (a - c) / denominator;
+    if (delta > 0.5) {
+        delta = 0.5;
+    } else if (delta < -0.5) {
+        delta = -0.5;
+    }
+    return k + delta;
+}
+
+// Function to estimate the frequency of bin k from its phase advance over one hop
+double peak_phase_bin(fft_complex_t previous, fft_complex_t current, int k, int n, int hop) {
+    // Advance beyond the bin centre's, wrapped to [-pi, pi]
+    double expected = 2 * M_PI * k * hop / n;
+    double deviation = carg(current * conj(previous)) - expected;
+    deviation -= 2 * M_PI * floor(deviation / (2 * M_PI) + 0.5);
+    return k + deviation * n / (2 * M_PI * hop);
+}
+
+// Function to create a top-K peak picker
+peak_picker_t *peak_picker_create(int num_bins, int max_peaks) {
+    if (num_bins < 3 || max_peaks < 1) {
+        printf("Error: Invalid peak picker parameters.\n");
+        return NULL;
+    }
+
+    peak_picker_t *picker = calloc(1, sizeof(*picker));
+    if (!picker) {
+        return NULL;
+    }
+    picker->num_bins = num_bins;
+    picker->max_peaks = max_peaks;
+    picker->candidates = malloc((num_bins / 2 + 1) * sizeof(peak_t));
+    if (!picker->candidates) {
+        peak_picker_destroy(picker);
+        return NULL;
+    }
+    return picker;
+}
+
+// Function to collect every local maximum at or above the threshold
+static int find_local_maxima(const peak_picker_t *picker, const double *magnitude, peak_t *candidates) {
+    int count = 0;
+    int last = picker->num_bins - 1;
+    int i = 1;
+
+#if SIMD_WIDTH > 1
+    // m[i] > m[i - 1] && m[i] >= m[i + 1] && m[i] >= threshold, one vector of bins at a time
+    simd_t threshold = simd_set1(picker->threshold);
+    for (; i + SIMD_WIDTH <= last; i += SIMD_WIDTH) {
+        simd_t centre = simd_load(magnitude + i);
+        int mask = simd_gt_mask(centre, simd_load(magnitude + i - 1)) &
+                   simd_ge_mask(centre, simd_load(magnitude + i + 1)) &
+                   simd_ge_mask(centre, threshold);
+        while (mask) {
+            int lane = __builtin_ctz(mask);
+            mask &= mask - 1;
+            candidates[count].bin = i + lane;
+            candidates[count].magnitude = magnitude[i + lane];
+            count++;
+        }
+    }
+#endif
+    for (; i < last; i++) {
+        if (magnitude[i] > magnitude[i - 1] && magnitude[i] >= magnitude[i + 1] && magnitude[i] >= picker->threshold) {
+            candidates[count].bin = i;
+            candidates[count].magnitude = magnitude[i];
+            count++;
+        }
+    }
+    return count;
+}
+
+// Heap order: weakest on top of a min-heap, strongest on top of a max-heap.
+// Equal magnitudes rank the lower bin as stronger so results are deterministic.
+static int stronger(const peak_t *a, const peak_t *b) {
+    return a->magnitude > b->magnitude || (a->magnitude == b->magnitude && a->bin < b->bin);
+}
+
+static int heap_above(const peak_t *a, const peak_t *b, int min_heap) {
+    return min_heap ? stronger(b, a) : stronger(a, b);
+}
+
+static void heap_swap(peak_t *heap, int i, int j) {
+    peak_t t = heap[i];
+    heap[i] = heap[j];
+    heap[j] = t;
+}
+
+// Function to restore the heap order below slot i
+static void sift_down(peak_t *heap, int count, int i, int min_heap) {
+    for (;;) {
+        int top = i;
+        int left = 2 * i + 1;
+        if (left < count && heap_above(&heap[left], &heap[top], min_heap)) {
+            top = left;
+        }
+        if (left + 1 < count && heap_above(&heap[left + 1], &heap[top], min_heap)) {
+            top = left + 1;
+        }
+        if (top == i) {
+            return;
+        }
+        heap_swap(heap, i, top);
+        i = top;
+    }
+}
+
+// Function to restore the heap order above slot i
+static void sift_up(peak_t *heap, int i, int min_heap) {
+    while (i > 0 && heap_above(&heap[i], &heap[(i - 1) / 2], min_heap)) {
+        heap_swap(heap, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+// Function to check a candidate against the peaks already kept
+static int too_close(const peak_picker_t *picker, const peak_t *kept, int count, int bin) {
+    for (int j = 0; j < count; j++) {
+        int low = kept[j].bin < bin ? kept[j].bin : bin;
+        int high = kept[j].bin < bin ? bin : kept[j].bin;
+        if (high - low < picker->min_distance_bins) {
+            return 1;
+        }
+        if (picker->min_distance_cents > 0 && 1200.0 * log2((double)high / low) < picker->min_distance_cents) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Function to pick the strongest peaks of one spectrum
+int peak_picker_find(peak_picker_t *picker, const double *magnitude, peak_t *out) {
+    peak_t *candidates = picker->candidates;
+    int num_candidates = find_local_maxima(picker, magnitude, candidates);
+    int k = picker->max_peaks;
+    int count = 0;
+
+    if (picker->min_distance_bins <= 0 && picker->min_distance_cents <= 0) {
+        // Bounded min-heap of the K strongest in out[]: O(M log K) for M local maxima
+        for (int c = 0; c < num_candidates; c++) {
+            if (count < k) {
+                out[count] = candidates[c];
+                sift_up(out, count++, 1);
+            } else if (stronger(&candidates[c], &out[0])) {
+                out[0] = candidates[c];
+                sift_down(out, count, 0, 1);
+            }
+        }
+        // Drain the min-heap from the back so out[] ends strongest first
+        for (int n = count; n > 1; n--) {
+            heap_swap(out, 0, n - 1);
+            sift_down(out, n - 1, 0, 1);
+        }
+        return count;
+    }
+
+    // Greedy suppression needs the candidates strongest first: heapify them in
+    // O(M) and pop only until K peaks are kept
+    for (int i = num_candidates / 2 - 1; i >= 0; i--) {
+        sift_down(candidates, num_candidates, i, 0);
+    }
+    while (num_candidates > 0 && count < k) {
+        peak_t best = candidates[0];
+        candidates[0] = candidates[--num_candidates];
+        sift_down(candidates, num_candidates, 0, 0);
+        if (!too_close(picker, out, count, best.bin)) {
+            out[count++] = best;
+        }
+    }
+    return count;
+}
+
+void peak_picker_destroy(peak_picker_t *picker) {
+    if (!picker) return;
+    free(picker->candidates);
+    free(picker);
+}
@@ -0,0 +1,47 @@
+#ifndef _PEAK_H
+#define _PEAK_H
+
+#include "fft_engine.h"
+
+typedef enum {
+    PEAK_INTERP_NONE,      // integer bin
+    PEAK_INTERP_PARABOLIC, // parabola through the three linear magnitudes
+    PEAK_INTERP_GAUSSIAN   // parabola through the three log magnitudes: exact for a Gaussian peak,
+                           // within a few hundredths of a bin for Hann-windowed sinusoids
+} peak_interp_t;
+
+// Fractional bin position of the local maximum at bin k of magnitude[0 .. num_bins - 1]
+double peak_interpolate(const double *magnitude, int num_bins, int k, peak_interp_t method);
+
+// Phase-vocoder estimate: fractional bin of the sinusoid in bin k of an n-point
+// transform, from the same bin of two frames hop samples apart. Unambiguous
+// within +-n / (2 hop) bins of k.
+double peak_phase_bin(fft_complex_t previous, fft_complex_t current, int k, int n, int hop);
+
+typedef struct {
+    int bin;
+    double magnitude;
+} peak_t;
+
+// Top-K picker over local maxima of a magnitude spectrum; create once per
+// spectrum size, then set the options directly
+typedef struct {
+    int num_bins;
+    int max_peaks;             // K
+    double threshold;          // local maxima below this magnitude are ignored (0: off)
+    double min_distance_bins;  // kept peaks are at least this many bins apart (0: off)
+    double min_distance_cents; // ... and at least this many cents apart (0: off)
+    peak_t *candidates;        // scratch: local maxima of the last spectrum
+} peak_picker_t;
+
+// Create a picker for up to max_peaks peaks of num_bins-bin spectra; NULL on failure
+peak_picker_t *peak_picker_create(int num_bins, int max_peaks);
+
+// Find the strongest local maxima of magnitude[0 .. num_bins - 1] that respect
+// the threshold and the minimum distances (greedy non-maximum suppression,
+// strongest first). Writes them to out[] by decreasing magnitude; returns the count.
+int peak_picker_find(peak_picker_t *picker, const double *magnitude, peak_t *out);
+
+void peak_picker_destroy(peak_picker_t *picker);
+
+#endif
@@ -0,0 +1,82 @@
+#include <stdlib.h>
+#include <complex.h>
+#include <math.h>
+
+#include "sdft.h"
+
+// Function to create a sliding DFT with all-zero history
+sdft_t *sdft_create(int n, const int *bins, int num_bins) {
+    if (n < 1 || num_bins < 1) {
+        return NULL;
+    }
+
+    sdft_t *sdft = calloc(1, sizeof(*sdft));
+    if (!sdft) {
+        return NULL;
+    }
+    sdft->n = n;
+    sdft->num_bins = num_bins;
+    sdft->bins = malloc(num_bins * sizeof(int));
+    sdft->roots = malloc(n * sizeof(fft_complex_t));
+    sdft->spectrum = calloc(num_bins, sizeof(fft_complex_t));
+    sdft->shadow = calloc(num_bins, sizeof(fft_complex_t));
+    sdft->shadow_index = calloc(num_bins, sizeof(int));
+    sdft->history = calloc(n, sizeof(double));
+    if (!sdft->bins || !sdft->roots || !sdft->spectrum || !sdft->shadow || !sdft->shadow_index || !sdft->history) {
+        sdft_destroy(sdft);
+        return NULL;
+    }
+
+    for (int m = 0; m < n; m++) {
+        sdft->roots[m] = cexp(-I * 2 * M_PI * m / n);
+    }
+    for (int b = 0; b < num_bins; b++) {
+        sdft->bins[b] = ((bins[b] % n) + n) % n;
+    }
+    return sdft;
+}
+
+// Function to slide the window by one sample
+void sdft_push(sdft_t *sdft, double sample) {
+    int n = sdft->n;
+    double delta = sample - sdft->history[sdft->pos];
+    sdft->history[sdft->pos] = sample;
+    if (++sdft->pos == n) {
+        sdft->pos = 0;
+    }
+
+    for (int b = 0; b < sdft->num_bins; b++) {
+        int k = sdft->bins[b];
+
+        // X_k <- (X_k + x_new - x_old) * exp(+i 2 pi k / n)
+        sdft->spectrum[b] = (sdft->spectrum[b] + delta) * conj(sdft->roots[k]);
+
+        // Shadow term x * exp(-i 2 pi k j / n) with an exact table twiddle
+        sdft->shadow[b] += sample * sdft->roots[sdft->shadow_index[b]];
+        sdft->shadow_index[b] += k;
+        if (sdft->shadow_index[b] >= n) {
+            sdft->shadow_index[b] -= n;
+        }
+    }
+
+    // After n samples the shadow is the exact DFT of the current window: re-anchor
+    if (++sdft->since_anchor == n) {
+        for (int b = 0; b < sdft->num_bins; b++) {
+            sdft->spectrum[b] = sdft->shadow[b];
+            sdft->shadow[b] = 0;
+            sdft->shadow_index[b] = 0;
+        }
+        sdft->since_anchor = 0;
+    }
+}
+
+void sdft_destroy(sdft_t *sdft) {
+    if (!sdft) return;
+    free(sdft->bins);
+    free(sdft->roots);
+    free(sdft->spectrum);
+    free(sdft->shadow);
+    free(sdft->shadow_index);
+    free(sdft->history);
+    free(sdft);
+}
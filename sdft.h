@@ -0,0 +1,30 @@
+#ifndef _SDFT_H
+#define _SDFT_H
+
+#include "fft_engine.h"
+
+// Sliding DFT over a chosen set of bins of an n-point window: O(num_bins) work
+// per sample. A shadow DFT of the next window is accumulated directly alongside
+// the recursion and replaces it every n samples, so rounding drift stays bounded.
+typedef struct {
+    int n;
+    int num_bins;
+    int *bins;                // DFT bin index of each tracked bin
+    fft_complex_t *roots;     // n entries: exp(-i 2 pi m / n)
+    fft_complex_t *spectrum;  // current DFT of the last n samples, oldest sample first
+    fft_complex_t *shadow;    // exact DFT of the samples since the last anchor
+    int *shadow_index;        // per bin: k * j mod n for the next shadow term
+    double *history;          // ring of the last n samples
+    int pos;                  // ring slot of the oldest sample
+    int since_anchor;         // samples accumulated in the shadow
+} sdft_t;
+
+// Track bins[0 .. num_bins - 1] of an n-point DFT; NULL on failure
+sdft_t *sdft_create(int n, const int *bins, int num_bins);
+
+// Slide the window by one sample and update every tracked bin
+void sdft_push(sdft_t *sdft, double sample);
+
+void sdft_destroy(sdft_t *sdft);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef _SIMD_H
+#define _SIMD_H
+
+// Thin layer over the widest double-precision vector unit the build targets:
+// AVX-512 (8 lanes), AVX (4), SSE2 (2), or none (SIMD_WIDTH 1, scalar code only).
+// simd_fmadd(a, b, c) = a * b + c, fused when the build targets FMA.
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#define SIMD_WIDTH 8
+typedef __m512d simd_t;
+#define simd_load(p) _mm512_loadu_pd(p)
+#define simd_store(p, v) _mm512_storeu_pd(p, v)
+#define simd_set1(x) _mm512_set1_pd(x)
+#define simd_add(a, b) _mm512_add_pd(a, b)
+#define simd_sub(a, b) _mm512_sub_pd(a, b)
+#define simd_mul(a, b) _mm512_mul_pd(a, b)
+#define simd_fmadd(a, b, c) _mm512_fmadd_pd(a, b, c)
+#define simd_gt_mask(a, b) (int)_mm512_cmp_pd_mask(a, b, _CMP_GT_OQ) // bit i: a[i] > b[i]
+#define simd_ge_mask(a, b) (int)_mm512_cmp_pd_mask(a, b, _CMP_GE_OQ)
+#elif defined(__AVX__)
+#include <immintrin.h>
+#define SIMD_WIDTH 4
+typedef __m256d simd_t;
+#define simd_load(p) _mm256_loadu_pd(p)
+#define simd_store(p, v) _mm256_storeu_pd(p, v)
+#define simd_set1(x) _mm256_set1_pd(x)
+#define simd_add(a, b) _mm256_add_pd(a, b)
+#define simd_sub(a, b) _mm256_sub_pd(a, b)
+#define simd_mul(a, b) _mm256_mul_pd(a, b)
+#if defined(__FMA__)
+#define simd_fmadd(a, b, c) _mm256_fmadd_pd(a, b, c)
+#else
+#define simd_fmadd(a, b, c) _mm256_add_pd(_mm256_mul_pd(a, b), c)
+#endif
+#define simd_gt_mask(a, b) _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ))
+#define simd_ge_mask(a, b) _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_GE_OQ))
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SIMD_WIDTH 2
+typedef __m128d simd_t;
+#define simd_load(p) _mm_loadu_pd(p)
+#define simd_store(p, v) _mm_storeu_pd(p, v)
+#define simd_set1(x) _mm_set1_pd(x)
+#define simd_add(a, b) _mm_add_pd(a, b)
+#define simd_sub(a, b) _mm_sub_pd(a, b)
+#define simd_mul(a, b) _mm_mul_pd(a, b)
+#if defined(__FMA__)
+#include <immintrin.h>
+#define simd_fmadd(a, b, c) _mm_fmadd_pd(a, b, c)
+#else
+#define simd_fmadd(a, b, c) _mm_add_pd(_mm_mul_pd(a, b), c)
+#endif
+#define simd_gt_mask(a, b) _mm_movemask_pd(_mm_cmpgt_pd(a, b))
+#define simd_ge_mask(a, b) _mm_movemask_pd(_mm_cmpge_pd(a, b))
+#else
+#define SIMD_WIDTH 1
+#endif
+
+#endif
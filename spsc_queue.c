@@ -0,0 +1,143 @@
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "spsc_queue.h"
+
+#define SPSC_SPIN_LIMIT 64 // polls before going to sleep
+
+// Function to sleep while *word still holds expected (or until a wake)
+static void futex_wait(atomic_uint *word, unsigned int expected) {
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+// Function to wake the thread sleeping on word, if any
+static void futex_wake(atomic_uint *word) {
+    atomic_fetch_add_explicit(word, 1, memory_order_release);
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+// Function to create a queue with a power-of-two number of slots
+spsc_queue_t *spsc_create(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    spsc_queue_t *queue = aligned_alloc(SPSC_CACHE_LINE, sizeof(spsc_queue_t));
+    if (!queue) {
+        return NULL;
+    }
+    queue->mask = size - 1;
+    queue->slots = calloc(size, sizeof(void *));
+    if (!queue->slots) {
+        free(queue);
+        return NULL;
+    }
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    queue->cached_head = 0;
+    queue->cached_tail = 0;
+    atomic_init(&queue->pushes, 0);
+    atomic_init(&queue->pops, 0);
+    atomic_init(&queue->consumer_waiting, 0);
+    atomic_init(&queue->producer_waiting, 0);
+    return queue;
+}
+
+bool spsc_push(spsc_queue_t *queue, void *item) {
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    if (tail - queue->cached_head > queue->mask) {
+        queue->cached_head = atomic_load_explicit(&queue->head, memory_order_acquire);
+        if (tail - queue->cached_head > queue->mask) {
+            return false;
+        }
+    }
+    queue->slots[tail & queue->mask] = item;
+    // Release: the slot (and whatever the handle points to) is visible before the new tail
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    // Pairs with the fence in spsc_pop_wait: either the consumer sees the new
+    // tail before sleeping or this sees it waiting
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&queue->consumer_waiting, memory_order_relaxed)) {
+        futex_wake(&queue->pushes);
+    }
+    return true;
+}
+
+void *spsc_pop(spsc_queue_t *queue) {
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    if (head == queue->cached_tail) {
+        queue->cached_tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+        if (head == queue->cached_tail) {
+            return NULL;
+        }
+    }
+    void *item = queue->slots[head & queue->mask];
+    // Release: the slot is read before the producer may reuse it
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    // Pairs with the fence in spsc_push_wait
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&queue->producer_waiting, memory_order_relaxed)) {
+        futex_wake(&queue->pops);
+    }
+    return item;
+}
+
+size_t spsc_count(spsc_queue_t *queue) {
+    size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    return tail - head;
+}
+
+void spsc_push_wait(spsc_queue_t *queue, void *item) {
+    for (int spins = 0; spins < SPSC_SPIN_LIMIT; spins++) {
+        if (spsc_push(queue, item)) {
+            return;
+        }
+    }
+    for (;;) {
+        // Read the futex word before announcing the wait, so a pop after the
+        // check below changes it and the sleep returns at once
+        unsigned int seen = atomic_load_explicit(&queue->pops, memory_order_acquire);
+        atomic_store_explicit(&queue->producer_waiting, 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        bool pushed = spsc_push(queue, item);
+        if (!pushed) {
+            futex_wait(&queue->pops, seen);
+        }
+        atomic_store_explicit(&queue->producer_waiting, 0, memory_order_relaxed);
+        if (pushed) {
+            return;
+        }
+    }
+}
+
+void *spsc_pop_wait(spsc_queue_t *queue) {
+    void *item;
+    for (int spins = 0; spins < SPSC_SPIN_LIMIT; spins++) {
+        if ((item = spsc_pop(queue))) {
+            return item;
+        }
+    }
+    for (;;) {
+        unsigned int seen = atomic_load_explicit(&queue->pushes, memory_order_acquire);
+        atomic_store_explicit(&queue->consumer_waiting, 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        item = spsc_pop(queue);
+        if (!item) {
+            futex_wait(&queue->pushes, seen);
+        }
+        atomic_store_explicit(&queue->consumer_waiting, 0, memory_order_relaxed);
+        if (item) {
+            return item;
+        }
+    }
+}
+
+void spsc_destroy(spsc_queue_t *queue) {
+    if (!queue) return;
+    free(queue->slots);
+    free(queue);
+}
@@ -0,0 +1,48 @@
+#ifndef _SPSC_QUEUE_H
+#define _SPSC_QUEUE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SPSC_CACHE_LINE 64
+
+// Bounded lock-free single-producer / single-consumer queue of non-NULL
+// handles. Exactly one thread may push and one other thread may pop; each
+// side caches the other's index so the shared cache lines are only touched
+// when the cached view says the queue is full or empty. A side that has to
+// wait sleeps on a futex and the other side wakes it; the wake costs a
+// syscall only while someone is actually asleep.
+typedef struct {
+    size_t mask;   // capacity - 1 (capacity is a power of two)
+    void **slots;
+    _Alignas(SPSC_CACHE_LINE) atomic_size_t head; // next slot to pop, written by the consumer
+    size_t cached_tail;                           // consumer's last view of tail
+    _Alignas(SPSC_CACHE_LINE) atomic_size_t tail; // next slot to push, written by the producer
+    size_t cached_head;                           // producer's last view of head
+    _Alignas(SPSC_CACHE_LINE) atomic_uint pushes; // futex word: bumped by a push while the consumer sleeps
+    atomic_uint pops;                             // futex word: bumped by a pop while the producer sleeps
+    atomic_int consumer_waiting;
+    atomic_int producer_waiting;
+} spsc_queue_t;
+
+// Create a queue holding at least capacity handles; NULL on failure
+spsc_queue_t *spsc_create(size_t capacity);
+
+// Producer: enqueue item (non-NULL); false if the queue is full
+bool spsc_push(spsc_queue_t *queue, void *item);
+
+// Consumer: dequeue the oldest item; NULL if the queue is empty
+void *spsc_pop(spsc_queue_t *queue);
+
+// Either side: items currently queued (a snapshot; exact only from a quiescent queue)
+size_t spsc_count(spsc_queue_t *queue);
+
+// Blocking variants: spin briefly, then sleep until there is room / an item.
+// Waiting for room is the backpressure; nothing is ever dropped.
+void spsc_push_wait(spsc_queue_t *queue, void *item);
+void *spsc_pop_wait(spsc_queue_t *queue);
+
+void spsc_destroy(spsc_queue_t *queue);
+
+#endif
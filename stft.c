@@ -0,0 +1,88 @@
+#include <stdlib.h>
+#include <math.h>
+
+#include "stft.h"
+
+// Periodic windows, so overlapped frames sum to a constant at the usual hops
+static void fill_window(double *w, int n, stft_window_t window) {
+    for (int i = 0; i < n; i++) {
+        double x = 2 * M_PI * i / n;
+        switch (window) {
+        case STFT_WINDOW_HANN:
+            w[i] = 0.5 - 0.5 * cos(x);
+            break;
+        case STFT_WINDOW_BLACKMAN_HARRIS:
+            w[i] = 0.35875 - 0.48829 * cos(x) + 0.14128 * cos(2 * x) - 0.01168 * cos(3 * x);
+            break;
+        default:
+            w[i] = 1.0;
+            break;
+        }
+    }
+}
+
+// Function to create an STFT framer with a precomputed window
+stft_t *stft_create(int frame_size, int hop, stft_window_t window) {
+    if (frame_size < 1 || hop < 1 || hop > frame_size) {
+        return NULL;
+    }
+
+    stft_t *stft = calloc(1, sizeof(*stft));
+    if (!stft) {
+        return NULL;
+    }
+    stft->frame_size = frame_size;
+    stft->hop = hop;
+    stft->until_hop = frame_size;
+    stft->window = malloc(frame_size * sizeof(double));
+    stft->ring = calloc(2 * (size_t)frame_size, sizeof(double));
+    stft->frame = malloc(frame_size * sizeof(double));
+    if (!stft->window || !stft->ring || !stft->frame) {
+        stft_destroy(stft);
+        return NULL;
+    }
+    fill_window(stft->window, frame_size, window);
+    return stft;
+}
+
+// Function to push samples and emit a windowed frame every hop
+int stft_push(stft_t *stft, const double *samples, int count, stft_frame_fn fn, void *user) {
+    int n = stft->frame_size;
+    int frames = 0;
+
+    for (int i = 0; i < count; i++) {
+        // Each sample is written twice, so ring[write_pos .. write_pos + n) is
+        // always the latest frame in order and nothing is shifted per hop
+        stft->ring[stft->write_pos] = samples[i];
+        stft->ring[stft->write_pos + n] = samples[i];
+        if (++stft->write_pos == n) {
+            stft->write_pos = 0;
+        }
+
+        if (--stft->until_hop == 0) {
+            const double *latest = stft->ring + stft->write_pos;
+            for (int j = 0; j < n; j++) {
+                stft->frame[j] = latest[j] * stft->window[j];
+            }
+            fn(stft->frame, n, user);
+            stft->until_hop = stft->hop;
+            frames++;
+        }
+    }
+
+    return frames;
+}
+
+// Function to start a new stream: the next frame_size samples complete the first frame
+void stft_reset(stft_t *stft) {
+    stft->write_pos = 0;
+    stft->until_hop = stft->frame_size;
+}
+
+void stft_destroy(stft_t *stft) {
+    if (!stft) return;
+    free(stft->window);
+    free(stft->ring);
+    free(stft->frame);
+    free(stft);
+}
@@ -0,0 +1,35 @@
+#ifndef _STFT_H
+#define _STFT_H
+
+typedef enum {
+    STFT_WINDOW_RECTANGULAR,
+    STFT_WINDOW_HANN,
+    STFT_WINDOW_BLACKMAN_HARRIS
+} stft_window_t;
+
+// Called once per hop with frame_size windowed samples, oldest first
+typedef void (*stft_frame_fn)(const double *frame, int frame_size, void *user);
+
+// Overlapping STFT framer: arbitrary-size pushes in, one windowed frame per hop out
+typedef struct {
+    int frame_size;
+    int hop;
+    double *window; // frame_size precomputed coefficients
+    double *ring;   // 2 * frame_size: every sample is stored twice so each frame is contiguous
+    double *frame;  // windowed output frame
+    int write_pos;  // ring slot of the next sample; also where the current frame starts
+    int until_hop;  // samples still needed before the next frame is emitted
+} stft_t;
+
+// Create a framer; hop must be in 1 .. frame_size. NULL on failure.
+stft_t *stft_create(int frame_size, int hop, stft_window_t window);
+
+// Push count samples; calls fn for every frame completed. Returns frames emitted.
+int stft_push(stft_t *stft, const double *samples, int count, stft_frame_fn fn, void *user);
+
+// Forget buffered samples so the framer can be reused for an unrelated stream
+void stft_reset(stft_t *stft);
+
+void stft_destroy(stft_t *stft);
+
+#endif
@@ -0,0 +1,285 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "wav_reader.h"
+
+static uint16_t read_le16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t read_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Parse a fmt chunk body; returns 0 if the format is one we can decode
+static int parse_fmt_chunk(const uint8_t *body, uint32_t size, wav_format_t *format) {
+    if (size < 16) {
+        return -1;
+    }
+    format->format = read_le16(body);
+    format->channels = read_le16(body + 2);
+    format->sample_rate = (int)read_le32(body + 4);
+    format->block_align = read_le16(body + 12);
+    format->bits_per_sample = read_le16(body + 14);
+
+    // WAVE_FORMAT_EXTENSIBLE: the real format is the first two bytes of the sub-format GUID
+    if (format->format == WAVE_FORMAT_EXTENSIBLE) {
+        if (size < 40) {
+            return -1;
+        }
+        format->format = read_le16(body + 24);
+    }
+
+    if (format->channels < 1 || format->block_align < format->channels) {
+        return -1;
+    }
+    if (format->format == WAVE_FORMAT_PCM) {
+        int bits = format->bits_per_sample;
+        if (bits != 8 && bits != 16 && bits != 24 && bits != 32) return -1;
+    } else if (format->format == WAVE_FORMAT_IEEE_FLOAT) {
+        if (format->bits_per_sample != 32) return -1;
+    } else {
+        return -1;
+    }
+    if (format->block_align != format->channels * format->bits_per_sample / 8) {
+        return -1;
+    }
+    return 0;
+}
+
+// Function to open a WAV file and position it at the start of the data chunk
+wav_reader_t *wav_open(const char *filename, size_t buffer_size) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        return NULL;
+    }
+
+    uint8_t header[12];
+    if (fread(header, 1, 12, file) != 12 || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0) {
+        fclose(file);
+        return NULL;
+    }
+
+    // Walk the chunks: remember fmt, skip LIST/fact/etc., stop at data
+    wav_format_t format;
+    int have_format = 0;
+    uint8_t chunk[8];
+    while (fread(chunk, 1, 8, file) == 8) {
+        uint32_t size = read_le32(chunk + 4);
+        uint32_t padded = size + (size & 1);
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            uint8_t body[64] = {0};
+            uint32_t keep = size < sizeof(body) ? size : sizeof(body);
+            if (fread(body, 1, keep, file) != keep || fseek(file, padded - keep, SEEK_CUR) != 0) {
+                break;
+            }
+            have_format = parse_fmt_chunk(body, size, &format) == 0;
+            if (!have_format) {
+                break;
+            }
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!have_format) {
+                break;
+            }
+            if (buffer_size == 0) {
+                buffer_size = WAV_DEFAULT_BUFFER_SIZE;
+            }
+            if (buffer_size < (size_t)format.block_align) {
+                buffer_size = format.block_align;
+            }
+
+            wav_reader_t *reader = calloc(1, sizeof(*reader));
+            uint8_t *buffer = malloc(buffer_size);
+            if (!reader || !buffer) {
+                free(reader);
+                free(buffer);
+                break;
+            }
+            // Our own buffer is the only one needed; large reads bypass stdio
+            setvbuf(file, NULL, _IONBF, 0);
+            reader->file = file;
+            reader->format = format;
+            // A size of 0 or 0xFFFFFFFF comes from writers that stream; read to end of file
+            reader->data_remaining = (size == 0 || size == 0xFFFFFFFF) ? UINT64_MAX : size;
+            reader->buffer = buffer;
+            reader->buffer_size = buffer_size;
+            return reader;
+        } else if (fseek(file, padded, SEEK_CUR) != 0) {
+            break;
+        }
+    }
+
+    fclose(file);
+    return NULL;
+}
+
+// Refill the buffer, keeping any partial frame at the front so frames stay whole
+static size_t refill(wav_reader_t *reader) {
+    size_t leftover = reader->buffer_len - reader->buffer_pos;
+    memmove(reader->buffer, reader->buffer + reader->buffer_pos, leftover);
+    reader->buffer_pos = 0;
+    reader->buffer_len = leftover;
+
+    size_t want = reader->buffer_size - leftover;
+    if (want > reader->data_remaining) {
+        want = (size_t)reader->data_remaining;
+    }
+    size_t got = want ? fread(reader->buffer + leftover, 1, want, reader->file) : 0;
+    reader->data_remaining -= got;
+    reader->buffer_len += got;
+    return got;
+}
+
+// Decode one sample of the given format to 16-bit PCM
+static int32_t decode_sample(const wav_format_t *format, const uint8_t *p) {
+    if (format->format == WAVE_FORMAT_IEEE_FLOAT) {
+        float f;
+        memcpy(&f, p, sizeof(f));
+        if (f >= 1.0f) return INT16_MAX;
+        if (f <= -1.0f) return INT16_MIN;
+        return (int32_t)(f * 32768.0f);
+    }
+    switch (format->bits_per_sample) {
+    case 8:
+        return ((int32_t)p[0] - 128) << 8;
+    case 16:
+        return (int16_t)read_le16(p);
+    case 24:
+        return (int16_t)read_le16(p + 1);
+    default:
+        return (int16_t)read_le16(p + 2);
+    }
+}
+
+// Function to read whole frames from the data chunk, mixed down to mono
+int wav_read_frames(wav_reader_t *reader, int16_t *out, int max_frames) {
+    const wav_format_t *format = &reader->format;
+    int frame_bytes = format->block_align;
+    int sample_bytes = format->bits_per_sample / 8;
+    int frames = 0;
+
+    while (frames < max_frames) {
+        if (reader->buffer_len - reader->buffer_pos < (size_t)frame_bytes) {
+            if (refill(reader) == 0) {
+                if (ferror(reader->file)) {
+                    return -1;
+                }
+                break;
+            }
+            continue;
+        }
+
+        const uint8_t *p = reader->buffer + reader->buffer_pos;
+        size_t available = (reader->buffer_len - reader->buffer_pos) / frame_bytes;
+        int count = max_frames - frames;
+        if ((size_t)count > available) {
+            count = (int)available;
+        }
+
+        if (format->channels == 1 && format->format == WAVE_FORMAT_PCM && sample_bytes == 2) {
+            // Common case: the data already is mono little-endian int16
+            for (int i = 0; i < count; i++) {
+                out[frames + i] = (int16_t)read_le16(p + 2 * i);
+            }
+        } else {
+            for (int i = 0; i < count; i++) {
+                int32_t sum = 0;
+                for (int c = 0; c < format->channels; c++) {
+                    sum += decode_sample(format, p + i * frame_bytes + c * sample_bytes);
+                }
+                out[frames + i] = (int16_t)(sum / format->channels);
+            }
+        }
+
+        reader->buffer_pos += (size_t)count * frame_bytes;
+        frames += count;
+    }
+
+    return frames;
+}
+
+void wav_close(wav_reader_t *reader) {
+    if (!reader) return;
+    fclose(reader->file);
+    free(reader->buffer);
+    free(reader);
+}
+
+// Function to map a WAV file and expose its data chunk as an int16 span
+wav_map_t *wav_map_open(const char *filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < 12) {
+        close(fd);
+        return NULL;
+    }
+    size_t size = (size_t)st.st_size;
+    uint8_t *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+
+    // Samples are consumed once, front to back
+    madvise(base, size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+    madvise(base, size, MADV_HUGEPAGE);
+#endif
+
+    if (memcmp(base, "RIFF", 4) != 0 || memcmp(base + 8, "WAVE", 4) != 0) {
+        munmap(base, size);
+        return NULL;
+    }
+
+    // Walk the chunks in place; chunks are word aligned so the data is int16 aligned
+    wav_format_t format;
+    int have_format = 0;
+    size_t pos = 12;
+    while (pos + 8 <= size) {
+        uint32_t chunk_size = read_le32(base + pos + 4);
+        const uint8_t *body = base + pos + 8;
+        size_t body_avail = size - pos - 8;
+
+        if (memcmp(base + pos, "fmt ", 4) == 0) {
+            have_format = chunk_size <= body_avail && parse_fmt_chunk(body, chunk_size, &format) == 0;
+            if (!have_format || format.format != WAVE_FORMAT_PCM || format.bits_per_sample != 16) {
+                break;
+            }
+        } else if (memcmp(base + pos, "data", 4) == 0) {
+            if (!have_format) {
+                break;
+            }
+            size_t data_size = chunk_size < body_avail ? chunk_size : body_avail;
+            wav_map_t *map = calloc(1, sizeof(*map));
+            if (!map) {
+                break;
+            }
+            map->map = base;
+            map->map_size = size;
+            map->format = format;
+            map->samples = (const int16_t *)body;
+            map->num_frames = data_size / format.block_align;
+            return map;
+        }
+        pos += 8 + (size_t)chunk_size + (chunk_size & 1);
+    }
+
+    munmap(base, size);
+    return NULL;
+}
+
+void wav_map_close(wav_map_t *map) {
+    if (!map) return;
+    munmap(map->map, map->map_size);
+    free(map);
+}
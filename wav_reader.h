@@ -0,0 +1,58 @@
+#ifndef _WAV_READER_H
+#define _WAV_READER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#define WAV_DEFAULT_BUFFER_SIZE (4 << 20) // Bytes per read() from the data chunk
+
+#define WAVE_FORMAT_PCM 0x0001
+#define WAVE_FORMAT_IEEE_FLOAT 0x0003
+#define WAVE_FORMAT_EXTENSIBLE 0xFFFE
+
+// Layout of the PCM data, from the fmt chunk (EXTENSIBLE resolved to its sub-format)
+typedef struct {
+    int format;          // WAVE_FORMAT_PCM or WAVE_FORMAT_IEEE_FLOAT
+    int channels;
+    int sample_rate;
+    int bits_per_sample; // 8, 16, 24 or 32 (PCM); 32 (float)
+    int block_align;     // bytes per frame (all channels)
+} wav_format_t;
+
+// Streaming reader over the data chunk of a RIFF/WAVE file
+typedef struct {
+    FILE *file;
+    wav_format_t format;
+    uint64_t data_remaining; // bytes of the data chunk not yet read from the file
+    uint8_t *buffer;
+    size_t buffer_size;
+    size_t buffer_pos;       // next unread byte in buffer
+    size_t buffer_len;       // valid bytes in buffer
+} wav_reader_t;
+
+// Open a WAV file and walk its chunks up to the PCM data; NULL on failure.
+// buffer_size is the read size in bytes (0 for WAV_DEFAULT_BUFFER_SIZE).
+wav_reader_t *wav_open(const char *filename, size_t buffer_size);
+
+// Read up to max_frames frames, mixed down to mono 16-bit PCM.
+// Returns the number of frames read, 0 at the end of the data, -1 on error.
+int wav_read_frames(wav_reader_t *reader, int16_t *out, int max_frames);
+
+void wav_close(wav_reader_t *reader);
+
+// Read-only memory map of a whole 16-bit PCM WAV file for zero-copy analysis
+typedef struct {
+    void *map;
+    size_t map_size;
+    wav_format_t format;
+    const int16_t *samples; // interleaved frames inside the mapped data chunk
+    size_t num_frames;
+} wav_map_t;
+
+// Map a 16-bit PCM WAV file and locate its data chunk; NULL on failure
+wav_map_t *wav_map_open(const char *filename);
+
+void wav_map_close(wav_map_t *map);
+
+#endif